@@ -21,6 +21,57 @@
 ----------------------------------------------------------------------------*/
 #include "PyDataProvider.hpp"
 
+#include <autodecref.h>
+#include <basewrapper.h>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+  // must be called with the GIL held
+  PyObject* shared_event_loop()
+  {
+    static PyObject* loop = nullptr;
+    if(!loop)
+    {
+      Shiboken::AutoDecRef globals(PyDict_New());
+      PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+      Shiboken::AutoDecRef result(
+          PyRun_String("import asyncio, threading\n"
+                       "loop = asyncio.new_event_loop()\n"
+                       "threading.Thread(target=loop.run_forever, "
+                       "name='SciQLop providers', daemon=True).start()\n",
+                       Py_file_input, globals, globals));
+      if(result.isNull())
+      {
+        PyErr_Print();
+        return nullptr;
+      }
+      // the GIL may have been released while starting the thread
+      if(!loop)
+      {
+        loop = PyDict_GetItemString(globals, "loop");
+        Py_XINCREF(loop);
+      }
+    }
+    return loop;
+  }
+
+  // must be called with the GIL held
+  PyTypeObject* time_serie_type()
+  {
+    static PyTypeObject* type = nullptr;
+    if(!type)
+    {
+      Shiboken::AutoDecRef module(PyImport_ImportModule("SciQLopBindings"));
+      if(!module.isNull())
+        type = reinterpret_cast<PyTypeObject*>(
+            PyObject_GetAttrString(module, "ITimeSerie"));
+    }
+    return type;
+  }
+} // namespace
+
 py::DataProvider::DataProvider(QObject* parent) : IDataProvider(parent) {}
 
 py::DataProvider::~DataProvider()
@@ -38,7 +89,8 @@ py::ITimeSerie* py::DataProvider::get_data(const QMap<QString, QString>& key,
 TimeSeries::ITimeSerie*
 py::DataProvider::getData(const DataProviderParameters& parameters)
 {
-  if(parameters.m_Data.contains("name"))
+  if(parameters.m_Data.contains("name") &&
+     !parameters.m_Cancellation.cancelled())
   {
     QMap<QString, QString> metadata;
     std::for_each(parameters.m_Data.constKeyValueBegin(),
@@ -46,12 +98,29 @@ py::DataProvider::getData(const DataProviderParameters& parameters)
                   [&metadata](const auto& item) {
                     metadata[item.first] = item.second.toString();
                   });
+    // the Python override takes the GIL only for the duration of the call
     auto result = get_data(metadata, parameters.m_Range.m_TStart,
                            parameters.m_Range.m_TEnd);
-    std::cout << "Before take" << std::endl;
-    auto ts = result->take();
-    delete result;
-    return ts;
+    if(result)
+    {
+      TimeSeries::ITimeSerie* ts = nullptr;
+      if(auto future = dynamic_cast<FutureTimeSerie*>(result))
+        ts = future->wait(parameters.m_Cancellation);
+      else
+        ts = result->take();
+      {
+        // result is still referenced by its Python wrapper
+        ScopedGILAcquire gil;
+        delete result;
+      }
+      // the request may have been superseded while Python was busy
+      if(parameters.m_Cancellation.cancelled())
+      {
+        delete ts;
+        return nullptr;
+      }
+      return ts;
+    }
   }
   return nullptr;
 }
@@ -74,8 +143,136 @@ void py::DataProvider::register_products(const QVector<Product*>& products)
   //                });
 }
 
+void py::DataProvider::fetch_products(const QString& path) { (void)path; }
+
+void py::DataProvider::fetchProducts(const QString& path)
+{
+  fetch_products(path);
+}
+
+void py::DataProvider::register_folders(const QStringList& paths)
+{
+  SciQLopCore::dataSources().addLazyFolders(this->name(), paths);
+}
+
+void py::DataProvider::remove_products(const QStringList& paths)
+{
+  SciQLopCore::dataSources().removeDataSourceItems(paths);
+}
+
+QStringList py::DataProvider::products() const
+{
+  return SciQLopCore::dataSources().products(this->name());
+}
+
+QMap<QString, QString>
+py::DataProvider::product_metadata(const QString& path) const
+{
+  QMap<QString, QString> metadata;
+  const auto data = SciQLopCore::dataSources().nodeData(path);
+  for(auto it = data.cbegin(); it != data.cend(); ++it)
+  {
+    if(it.key() != DataSourceItem::NAME_DATA_KEY &&
+       it.key() != DataSourceItem::PLUGIN_DATA_KEY)
+      metadata[it.key()] = it.value().toString();
+  }
+  return metadata;
+}
+
+bool py::DataProvider::load_inventory(const QString& version)
+{
+  return SciQLopCore::dataSources().loadInventory(this->name(), version);
+}
+
+bool py::DataProvider::save_inventory(const QString& version)
+{
+  return SciQLopCore::dataSources().saveInventory(this->name(), version);
+}
+
 py::ITimeSerie::ITimeSerie() : ts{nullptr} {}
 
+py::FutureTimeSerie::FutureTimeSerie(PyObject* future) : ITimeSerie{}
+{
+  Shiboken::AutoDecRef asyncio(PyImport_ImportModule("asyncio"));
+  if(asyncio.isNull()) return;
+  Shiboken::AutoDecRef is_coroutine(
+      PyObject_CallMethod(asyncio, "iscoroutine", "O", future));
+  if(!is_coroutine.isNull() && PyObject_IsTrue(is_coroutine))
+  {
+    if(auto loop = shared_event_loop())
+    {
+      Shiboken::AutoDecRef scheduled(PyObject_CallMethod(
+          asyncio, "run_coroutine_threadsafe", "OO", future, loop));
+      if(!scheduled.isNull())
+        this->future = PyObjectWrapper<>{scheduled.object()};
+    }
+  }
+  else if(PyObject_HasAttrString(future, "result") &&
+          PyObject_HasAttrString(future, "cancel"))
+  {
+    this->future = PyObjectWrapper<>{future};
+  }
+  else
+  {
+    PyErr_SetString(PyExc_TypeError,
+                    "FutureTimeSerie expects a coroutine or a future");
+  }
+}
+
+TimeSeries::ITimeSerie*
+py::FutureTimeSerie::wait(const CancellationToken& cancellation)
+{
+  // cancellation can come from any thread while we wait, the hook only
+  // borrows the future so it must be detached before we return
+  struct Hook
+  {
+    std::mutex mutex;
+    PyObject* future;
+  };
+  ScopedGILAcquire gil;
+  if(future.is_null()) return nullptr;
+  auto hook = std::make_shared<Hook>();
+  hook->future = future.py_object();
+  const auto hook_id = cancellation.onCancel([hook]() {
+    std::lock_guard<std::mutex> lock{hook->mutex};
+    if(hook->future)
+    {
+      ScopedGILAcquire gil;
+      Shiboken::AutoDecRef cancelled(
+          PyObject_CallMethod(hook->future, "cancel", nullptr));
+      if(cancelled.isNull()) PyErr_Clear();
+    }
+  });
+  // result() releases the GIL while it blocks
+  Shiboken::AutoDecRef value(
+      PyObject_CallMethod(future.py_object(), "result", nullptr));
+  {
+    ScopedGILRelease no_gil;
+    cancellation.removeOnCancel(hook_id);
+    std::lock_guard<std::mutex> lock{hook->mutex};
+    hook->future = nullptr;
+  }
+  if(value.isNull())
+  {
+    if(cancellation.cancelled())
+      PyErr_Clear();
+    else
+      PyErr_Print();
+    return nullptr;
+  }
+  auto type = time_serie_type();
+  if(type && Shiboken::Object::checkType(value) &&
+     PyObject_TypeCheck(value.object(), type))
+  {
+    auto wrapper =
+        reinterpret_cast<py::ITimeSerie*>(Shiboken::Object::cppPointer(
+            reinterpret_cast<SbkObject*>(value.object()), type));
+    return wrapper->take();
+  }
+  std::cerr << "FutureTimeSerie: result is not an ITimeSerie" << std::endl;
+  return nullptr;
+}
+
 py::ITimeSerie::ITimeSerie(TimeSeries::ITimeSerie* ts) : ts{ts} {}
 
 py::ITimeSerie::~ITimeSerie()
@@ -83,3 +280,27 @@ py::ITimeSerie::~ITimeSerie()
   std::cout << "py::ITimeSerie::~ITimeSerie()" << std::endl;
   if(ts) delete ts;
 }
+
+py::MappedTimeSerie::MappedTimeSerie(const QString& file) : m_mapped{file} {}
+
+double py::MappedTimeSerie::start() const noexcept
+{
+  return m_mapped.start();
+}
+
+double py::MappedTimeSerie::stop() const noexcept
+{
+  return m_mapped.stop();
+}
+
+py::ITimeSerie* py::MappedTimeSerie::slice(double start, double stop) const
+{
+  if(auto ts = m_mapped.slice(start, stop)) return new ITimeSerie{ts};
+  return nullptr;
+}
+
+bool py::MappedTimeSerie::write(const QString& file, ITimeSerie* ts)
+{
+  if(ts == nullptr || ts->get() == nullptr) return false;
+  return ::MappedTimeSerie::write(file, ts->get());
+}
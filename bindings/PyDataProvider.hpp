@@ -23,6 +23,7 @@
 #include <QList>
 #include <QPair>
 #include <SciQLopCore/Data/DataSeriesType.hpp>
+#include <SciQLopCore/Data/MappedTimeSerie.hpp>
 #include <SciQLopCore/DataSource/DataProviderParameters.hpp>
 #include <SciQLopCore/DataSource/DataSourceItem.hpp>
 #include <SciQLopCore/DataSource/DataSourceItemAction.hpp>
@@ -47,22 +48,30 @@ namespace py
       ts=nullptr;
       return result;
     }
+    inline TimeSeries::ITimeSerie* get() const noexcept { return ts; }
   private:
     TimeSeries::ITimeSerie* ts;
   };
 
+  inline std::size_t components_count(NpArray& time, NpArray& values)
+  {
+    if(const auto sz = time.flat_size(); sz != 0)
+      return values.flat_size() / sz;
+    return 0;
+  }
+
   struct ScalarTimeSerie : ITimeSerie
   {
     inline ScalarTimeSerie(NpArray time, NpArray values)
-        : ITimeSerie{new ::ScalarTimeSerie{std::move(time.data),
-                                           std::move(values.data)}}
+        : ITimeSerie{new ::ScalarTimeSerie{time.to_std_vect(),
+                                           values.to_std_vect()}}
     {}
   };
 
   struct VectorTimeSerie : ITimeSerie
   {
     inline VectorTimeSerie(NpArray time, NpArray values)
-        : ITimeSerie{new ::VectorTimeSerie{std::move(time.data),
+        : ITimeSerie{new ::VectorTimeSerie{time.to_std_vect(),
                                            values.to_std_vect_vect()}}
     {}
   };
@@ -71,9 +80,9 @@ namespace py
   {
     inline MultiComponentTimeSerie(NpArray time, NpArray values)
         : ITimeSerie{new ::MultiComponentTimeSerie{
-              std::move(time.data),
-              std::move(values.data),
-              {time.flat_size(), values.flat_size() / time.flat_size()}}}
+              time.to_std_vect(),
+              values.to_std_vect(),
+              {time.flat_size(), components_count(time, values)}}}
     {}
   };
 
@@ -81,15 +90,64 @@ namespace py
   {
     inline SpectrogramTimeSerie(NpArray time, NpArray y, NpArray values)
         : ITimeSerie{new ::SpectrogramTimeSerie{
-              std::move(time.data),
-              std::move(y.data),
-              std::move(values.data),
-              {time.flat_size(), values.flat_size() / time.flat_size()},
+              time.to_std_vect(),
+              y.to_std_vect(),
+              values.to_std_vect(),
+              {time.flat_size(), components_count(time, values)},
               std::nan("1"),
               std::nan("1")}}
     {}
   };
 
+  /**
+   * @brief Lets get_data return before its data are ready.
+   *
+   * Wraps either a coroutine, run on an event loop shared by all providers,
+   * or a concurrent.futures.Future like object. Both must resolve to an
+   * ITimeSerie. The fetching thread waits without holding the GIL and
+   * cancels the future when the request gets cancelled.
+   */
+  struct FutureTimeSerie : ITimeSerie
+  {
+    FutureTimeSerie(PyObject* future);
+    TimeSeries::ITimeSerie* wait(const CancellationToken& cancellation);
+
+  private:
+    PyObjectWrapper<> future;
+  };
+
+  /**
+   * @brief Time serie file mapped in memory, see ::MappedTimeSerie.
+   *
+   * Lets providers serve series larger than memory from local files:
+   * get_data can return slices of it, only the sliced samples are read.
+   */
+  class MappedTimeSerie
+  {
+  public:
+    MappedTimeSerie(const QString& file);
+
+    inline bool is_valid() const noexcept { return m_mapped.isValid(); }
+    inline DataSeriesType type() const noexcept
+    {
+      return m_mapped.layout().type;
+    }
+    inline std::size_t size() const noexcept { return m_mapped.size(); }
+    /// first sample time, NaN if empty
+    double start() const noexcept;
+    /// last sample time, NaN if empty
+    double stop() const noexcept;
+
+    /// Copies the samples within [start, stop] into a new time serie
+    ITimeSerie* slice(double start, double stop) const;
+
+    /// Writes @p ts to @p file, false if it can't be written
+    static bool write(const QString& file, ITimeSerie* ts);
+
+  private:
+    ::MappedTimeSerie m_mapped;
+  };
+
   class DataProvider : public IDataProvider
   {
     Q_OBJECT
@@ -107,5 +165,34 @@ namespace py
     void set_icon(const QString& path, const QString& name);
 
     void register_products(const QVector<Product*>& products);
+
+    /**
+     * @brief Python side of IDataProvider::fetchProducts, overridden by
+     * providers which registered folders with register_folders
+     */
+    virtual void fetch_products(const QString& path);
+
+    void fetchProducts(const QString& path) override;
+
+    void register_folders(const QStringList& paths);
+
+    void remove_products(const QStringList& paths);
+
+    /// Paths of the products registered so far, loaded inventory included
+    QStringList products() const;
+
+    /**
+     * @brief Metadata of the product at @p path as it was registered, so
+     * inventory deltas can spot the products which changed
+     */
+    QMap<QString, QString> product_metadata(const QString& path) const;
+
+    /**
+     * @brief Registers the products saved by save_inventory with the same
+     * @p version, returns false if the whole inventory has to be registered
+     */
+    bool load_inventory(const QString& version);
+
+    bool save_inventory(const QString& version);
   };
 } // namespace py
@@ -65,6 +65,43 @@ inline int init_numpy()
   return 0;
 }
 const static int numpy_initialized = init_numpy();
+
+/**
+ * @brief Releases the GIL for the lifetime of the object, only if the calling
+ * thread holds it.
+ */
+struct ScopedGILRelease
+{
+  ScopedGILRelease()
+      : _state{PyGILState_Check() ? PyEval_SaveThread() : nullptr}
+  {}
+  ~ScopedGILRelease()
+  {
+    if(_state) PyEval_RestoreThread(_state);
+  }
+  ScopedGILRelease(const ScopedGILRelease&) = delete;
+  ScopedGILRelease& operator=(const ScopedGILRelease&) = delete;
+
+private:
+  PyThreadState* _state;
+};
+
+/**
+ * @brief Holds the GIL for the lifetime of the object, from any thread.
+ */
+struct ScopedGILAcquire
+{
+  ScopedGILAcquire() : _state{PyGILState_Ensure()} {}
+  ~ScopedGILAcquire() { PyGILState_Release(_state); }
+  ScopedGILAcquire(const ScopedGILAcquire&) = delete;
+  ScopedGILAcquire& operator=(const ScopedGILAcquire&) = delete;
+
+private:
+  PyGILState_STATE _state;
+};
+
+// below this size releasing the GIL costs more than the copy itself
+constexpr std::size_t gil_free_copy_threshold = 1UL << 16;
 template<typename dest_type = PyObject> struct PyObjectWrapper
 {
 private:
@@ -183,7 +220,7 @@ public:
   std::size_t flat_size()
   {
     auto s = this->shape();
-    return std::accumulate(std::cbegin(s), std::cend(s), 1,
+    return std::accumulate(std::cbegin(s), std::cend(s), std::size_t{1},
                            [](const auto& a, const auto& b) { return a * b; });
   }
 
@@ -199,78 +236,78 @@ public:
   std::vector<double> to_std_vect()
   {
     assert(!this->_py_obj.is_null());
-    auto sz = flat_size();
-    std::vector<double> v(sz);
+    auto sz    = flat_size();
     auto d_ptr = reinterpret_cast<double*>(PyArray_DATA(_py_obj.get()));
-    std::copy(d_ptr, d_ptr + sz, std::begin(v));
-    return v;
+    if(sz < gil_free_copy_threshold)
+      return std::vector<double>(d_ptr, d_ptr + sz);
+    // the array stays alive since we hold a reference on it
+    ScopedGILRelease gil;
+    return std::vector<double>(d_ptr, d_ptr + sz);
   }
 
   std::vector<VectorTimeSerie::raw_value_type> to_std_vect_vect()
   {
     auto sz = size(0);
-    std::vector<VectorTimeSerie::raw_value_type> v(sz);
     if(sz)
     {
       assert(ndim() == 2);
       assert(size(1) == 3);
       auto d_ptr = reinterpret_cast<VectorTimeSerie::raw_value_type*>(
           PyArray_DATA(_py_obj.get()));
-      std::copy(d_ptr, d_ptr + sz, std::begin(v));
+      if(3 * sz < gil_free_copy_threshold)
+        return std::vector<VectorTimeSerie::raw_value_type>(d_ptr, d_ptr + sz);
+      ScopedGILRelease gil;
+      return std::vector<VectorTimeSerie::raw_value_type>(d_ptr, d_ptr + sz);
     }
-    return v;
+    return {};
   }
 
   PyObject* py_object() { return _py_obj.py_object(); }
 };
 
+/**
+ * @brief The NpArray struct holds a reference on a NumPy array passed from
+ * Python.
+ *
+ * No copy is made when the array crosses the bindings, samples are copied
+ * only once, straight from the NumPy buffer into the TimeSerie storage.
+ */
 struct NpArray
 {
-  std::vector<std::size_t> shape;
-  std::vector<double> data;
   static bool isNpArray(PyObject* obj) { return NpArray_view::isNpArray(obj); }
   NpArray() = default;
   explicit NpArray(PyObject* obj)
   {
-    if(obj)
-    {
-      NpArray_view view{obj};
-      shape = view.shape();
-      data  = view.to_std_vect();
-    }
+    if(obj) { view = NpArray_view{obj}; }
   }
 
-  inline std::size_t ndim() { return shape.size(); }
+  inline std::vector<std::size_t> shape() { return view.shape(); }
 
-  std::size_t size(std::size_t index = 0)
+  inline std::size_t ndim() { return view.ndim(); }
+
+  inline std::size_t size(std::size_t index = 0) { return view.size(index); }
+
+  inline std::size_t flat_size() { return view.flat_size(); }
+
+  inline std::vector<double> to_std_vect()
   {
-    if(index < shape.size()) return shape[index];
-    return 0;
+    if(view.py_object()) return view.to_std_vect();
+    return {};
   }
 
-  std::size_t flat_size()
+  inline std::vector<VectorTimeSerie::raw_value_type> to_std_vect_vect()
   {
-    return std::accumulate(std::cbegin(shape), std::cend(shape), 1,
-                           [](const auto& a, const auto& b) { return a * b; });
+    if(view.py_object()) return view.to_std_vect_vect();
+    return {};
   }
 
-  // TODO temporary hack should find a way to avoid this copy
-  std::vector<VectorTimeSerie::raw_value_type> to_std_vect_vect()
+  PyObject* py_object()
   {
-    auto sz = size(0);
-    std::vector<VectorTimeSerie::raw_value_type> v(sz);
-    if(sz)
-    {
-      assert(ndim() == 2);
-      assert(size(1) == 3);
-      auto d_ptr =
-          reinterpret_cast<VectorTimeSerie::raw_value_type*>(data.data());
-      std::copy(d_ptr, d_ptr + sz, std::begin(v));
-    }
-    return v;
+    auto obj = view.py_object();
+    Py_XINCREF(obj);
+    return obj;
   }
 
-  // TODO maybe ;)
-  PyObject* py_object() { return nullptr; }
+private:
+  NpArray_view view;
 };
-
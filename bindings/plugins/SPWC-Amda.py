@@ -65,44 +65,80 @@ def amda_get_sample(metadata, start, stop):
         return ts_type()
 
 
+# bumped when the products built below change for a same AMDA inventory
+INVENTORY_VERSION = "1"
+
+
+def amda_walk(node, path):
+    # speasy doesn't expose its index types publicly, only needed once the
+    # inventory gets synced
+    from speasy.core.inventory.indexes import SpeasyIndex, ParameterIndex, ComponentIndex
+    for child in node.__dict__.values():
+        if isinstance(child, ParameterIndex):
+            yield f"{path}/{child.spz_name()}", child
+        elif isinstance(child, SpeasyIndex) and not isinstance(child, ComponentIndex):
+            yield from amda_walk(child, f"{path}/{child.spz_name()}")
+
+
+def amda_metadata(parameter):
+    metadata = {key: value for key, value in parameter.__dict__.items() if isinstance(value, str)}
+    n_components = metadata.get('size', '0')
+    if n_components == '3':
+        metadata["type"] = "vector"
+        ds_type = DataSeriesType.VECTOR
+    elif metadata.get('display_type', '') == "spectrogram":
+        metadata["type"] = "spectrogram"
+        ds_type = DataSeriesType.SPECTROGRAM
+    elif n_components != '0':
+        metadata["type"] = "multicomponent"
+        ds_type = DataSeriesType.MULTICOMPONENT
+    else:
+        metadata["type"] = "scalar"
+        ds_type = DataSeriesType.SCALAR
+    return metadata, ds_type
+
+
+def amda_components(parameter):
+    from speasy.core.inventory.indexes import ComponentIndex
+    return [component.spz_name() for component in parameter.__dict__.values()
+            if isinstance(component, ComponentIndex)]
+
+
+def amda_parameters():
+    try:
+        return {path: parameter for path, parameter in amda_walk(spz.inventories.tree.amda, "/AMDA")}
+    except Exception as e:
+        print(traceback.format_exc())
+        print("Error in amda.py ", str(e))
+        return None
+
+
 class AmdaProvider(PyDataProvider):
     def __init__(self):
         super(AmdaProvider, self).__init__()
-        '''if len(amda.component) is 0:
-            amda.update_inventory()
-        parameters = copy.deepcopy(spz.inventory.flat_inventories.amda.parameter)
-        for name, component in spz.inventory.flat_inventories.amda.components.items():
-            if 'components' in parameters[component['parameter']]:
-                parameters[component['parameter']]['components'].append(component)
-            else:
-                parameters[component['parameter']]['components']=[component]
-
-        products = []
-        for key, parameter in parameters.items():
-            mission_name = amda.mission[parameter['mission']]['name']
-            observatory_name = parameter.get('observatory','')
-            if observatory_name != '':
-                observatory_name = amda.observatory[observatory_name]['name']
-            instrument_name = amda.instrument[parameter['instrument']]['name']
-            dataset_name = amda.dataset[parameter['dataset']]['name']
-            path = f"/AMDA/{mission_name}/{observatory_name}/{instrument_name}/{dataset_name}/{parameter['name']}"
-            components = [component['name'] for component in parameter.get('components',[])]
-            metadata = {key: item for key, item in parameter.items() if key is not 'components'}
-            n_components = parameter.get('size', 0)
-            if n_components == '3':
-                metadata["type"] = "vector"
-            elif parameter.get('display_type', '')=="spectrogram":
-                metadata["type"] = "spectrogram"
-            elif n_components != 0:
-                metadata["type"] = "multicomponent"
-            else:
-                metadata["type"] = "scalar"
-            products.append(Product(path, components, metadata))
-        self.register_products(products)
-        for _,mission in amda.mission.items():
-            if ('target' in mission) and (mission['xml:id'] != 'Ephemerides') and (mission['target'] != 'Earth'):
-                self.set_icon(f'/AMDA/{mission["name"]}','satellite')
-        '''
+        # AMDA products aren't registered yet, sync_inventory does it once
+        # they are enabled
+
+    def sync_inventory(self):
+        # the last inventory shows up at once, then only what changed is sent
+        self.load_inventory(INVENTORY_VERSION)
+        parameters = amda_parameters()
+        if parameters is None:
+            return
+        known = set(self.products())
+        removed = [path for path in known if path not in parameters]
+        if removed:
+            self.remove_products(removed)
+        # registered paths get their new metadata in place
+        changed = []
+        for path, parameter in parameters.items():
+            metadata, ds_type = amda_metadata(parameter)
+            if path not in known or self.product_metadata(path) != metadata:
+                changed.append(Product(path, amda_components(parameter), ds_type, metadata))
+        if changed:
+            self.register_products(changed)
+        if removed or changed:
+            self.save_inventory(INVENTORY_VERSION)
 
     def get_data(self, metadata, start, stop):
         ts_type = amda_make_scalar
@@ -117,7 +153,7 @@ class AmdaProvider(PyDataProvider):
                 ts_type = amda_make_spectro
             tstart = datetime.fromtimestamp(start, tz=timezone.utc)
             tend = datetime.fromtimestamp(stop, tz=timezone.utc)
-            var = amda.get_parameter(start_time=tstart, stop_time=tend, parameter_id=param_id, method="REST")
+            var = spz.amda.get_parameter(start_time=tstart, stop_time=tend, parameter_id=param_id, method="REST")
             return ts_type(var)
         except Exception as e:
             print(traceback.format_exc())
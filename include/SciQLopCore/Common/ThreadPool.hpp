@@ -0,0 +1,84 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The ThreadPool class runs jobs on a bounded set of worker threads.
+ *
+ * Each job belongs to a group (typically the data provider it calls) and a
+ * group never runs more than its concurrency limit at once, so a slow group
+ * cannot hold every worker while other groups have work waiting. Idle workers
+ * pick the oldest job whose group is below its limit. Exceptions thrown by
+ * jobs are logged and dropped.
+ */
+class ThreadPool
+{
+public:
+  using group_t = const void*;
+  using job_t   = std::function<void()>;
+
+  /**
+   * @param threads number of worker threads, defaults to the number of cores
+   * @param group_limit default maximum number of jobs of a same group running
+   * at once, defaults to half the worker threads
+   */
+  explicit ThreadPool(std::size_t threads = 0, std::size_t group_limit = 0);
+  ~ThreadPool();
+
+  /**
+   * @brief Queues @p job, jobs already queued are still run when the pool
+   * gets destroyed but new ones are refused
+   * @return false if the pool is closing and @p job was dropped
+   */
+  bool submit(group_t group, job_t job);
+
+  void setGroupLimit(group_t group, std::size_t limit);
+
+  inline std::size_t size() const noexcept { return std::size(m_workers); }
+
+private:
+  struct queued_job_t
+  {
+    group_t group;
+    job_t job;
+  };
+
+  void work();
+  std::size_t limit(group_t group) const;
+
+  std::vector<std::thread> m_workers;
+  std::deque<queued_job_t> m_jobs;
+  std::map<group_t, std::size_t> m_running;
+  std::map<group_t, std::size_t> m_limits;
+  std::size_t m_default_limit;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_closing = false;
+};
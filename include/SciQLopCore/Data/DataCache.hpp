@@ -0,0 +1,218 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DateTimeRange.hpp"
+#include "SciQLopCore/Data/TimeSerieMerge.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The DataCache class keeps the samples already fetched for a product
+ * and the time range they cover.
+ *
+ * Samples are stored the way pipelines send them to graphs: one time axis and
+ * all components stored one after the other. When a new range is requested
+ * only the sub-ranges not covered by the cache (see DateTimeRange::operator-)
+ * are fetched, then stitched with the cached samples.
+ */
+class DataCache
+{
+public:
+  using data_t = std::pair<std::vector<double>, std::vector<double>>;
+
+  /**
+   * @param components number of components per sample
+   * @param max_span_factor the cache never holds more than max_span_factor
+   * times the last requested range
+   */
+  explicit DataCache(std::size_t components, double max_span_factor = 3.)
+      : m_components{components}, m_max_span_factor{max_span_factor}
+  {}
+
+  /**
+   * @brief Gets the samples for the given range, calling @p fetch for every
+   * sub-range not present in the cache.
+   * @param range the requested range
+   * @param fetch callable with signature
+   * std::optional<data_t>(const DateTimeRange&), returning an empty optional
+   * aborts the request and leaves the cache untouched, so failed or
+   * cancelled fetches must return one to be retried later. An engaged empty
+   * data_t means the range holds no sample and gets cached as such.
+   * @return the samples within range or an empty optional if a fetch was
+   * aborted
+   */
+  template<typename fetch_t>
+  std::optional<data_t> get(const DateTimeRange& range, fetch_t&& fetch)
+  {
+    if(!range.intersect(m_range))
+    {
+      auto data = fetch(range);
+      if(!data) return std::nullopt;
+      replace(range, std::move(*data));
+    }
+    else
+    {
+      std::optional<data_t> left{data_t{}}, right{data_t{}};
+      for(const auto& missing : range - m_range)
+      {
+        if(missing.m_TStart < m_range.m_TStart)
+          left = fetch(missing);
+        else
+          right = fetch(missing);
+        if(!left || !right) return std::nullopt;
+      }
+      if(compatible(*left) && compatible(*right))
+        stitch(std::move(*left), std::move(*right),
+               {std::min(range.m_TStart, m_range.m_TStart),
+                std::max(range.m_TEnd, m_range.m_TEnd)});
+      else
+      {
+        auto data = fetch(range);
+        if(!data) return std::nullopt;
+        replace(range, std::move(*data));
+      }
+    }
+    trim(range * m_max_span_factor);
+    return slice(range);
+  }
+
+  inline DateTimeRange range() const noexcept { return m_range; }
+
+  inline void clear() noexcept
+  {
+    m_range = INVALID_RANGE;
+    m_data  = data_t{};
+  }
+
+private:
+  struct span_t
+  {
+    const data_t* data;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  static inline std::size_t lower_index(const std::vector<double>& x,
+                                        double value)
+  {
+    return std::distance(std::cbegin(x),
+                         std::lower_bound(std::cbegin(x), std::cend(x), value));
+  }
+
+  static inline std::size_t upper_index(const std::vector<double>& x,
+                                        double value)
+  {
+    return std::distance(std::cbegin(x),
+                         std::upper_bound(std::cbegin(x), std::cend(x), value));
+  }
+
+  inline bool compatible(const data_t& data) const noexcept
+  {
+    return std::size(data.second) == std::size(data.first) * m_components;
+  }
+
+  void replace(const DateTimeRange& range, data_t&& data)
+  {
+    m_range = range;
+    if(const auto sz = std::size(data.first);
+       sz != 0 && std::size(data.second) % sz == 0)
+      m_components = std::size(data.second) / sz;
+    if(compatible(data))
+      m_data = std::move(data);
+    else
+      m_data = data_t{};
+  }
+
+  /**
+   * Copies @p spans back to back, samples of a span which aren't after the
+   * last one kept from the previous spans are dropped, see
+   * TimeSeriesUtils::trim_overlaps
+   */
+  data_t concat(const std::vector<span_t>& spans) const
+  {
+    // trimming only looks at time axes, values are ignored
+    std::vector<TimeSerieView> chunks;
+    chunks.reserve(std::size(spans));
+    for(const auto& s : spans)
+      chunks.push_back({std::data(s.data->first) + s.begin, nullptr,
+                        s.end - s.begin, 0});
+    const auto size = TimeSeriesUtils::trim_overlaps(chunks);
+    data_t result{std::vector<double>(size),
+                  std::vector<double>(size * m_components)};
+    auto t = std::data(result.first);
+    for(const auto& chunk : chunks)
+      t = std::copy_n(chunk.t, chunk.size, t);
+    // components are stored one after the other, each one is copied as a
+    // single column serie
+    std::vector<TimeSerieView> columns(std::size(chunks));
+    for(auto comp = 0UL; comp < m_components; comp++)
+    {
+      for(auto i = 0UL; i < std::size(chunks); i++)
+      {
+        const auto& [x, values] = *spans[i].data;
+        const auto offset =
+            static_cast<std::size_t>(chunks[i].t - std::data(x));
+        columns[i] = {chunks[i].t,
+                      std::data(values) + comp * std::size(x) + offset,
+                      chunks[i].size, 1};
+      }
+      TimeSeriesUtils::copy_chunks(columns, nullptr,
+                                   std::data(result.second) + comp * size);
+    }
+    return result;
+  }
+
+  void stitch(data_t&& left, data_t&& right, const DateTimeRange& new_range)
+  {
+    // samples at the edges of the cache are only kept once, the time axis
+    // must stay strictly increasing
+    m_data  = concat({{&left, 0UL, std::size(left.first)},
+                      {&m_data, 0UL, std::size(m_data.first)},
+                      {&right, 0UL, std::size(right.first)}});
+    m_range = new_range;
+  }
+
+  void trim(const DateTimeRange& window)
+  {
+    if(m_range.m_TStart < window.m_TStart || m_range.m_TEnd > window.m_TEnd)
+    {
+      m_range = {std::max(m_range.m_TStart, window.m_TStart),
+                 std::min(m_range.m_TEnd, window.m_TEnd)};
+      m_data  = slice(m_range);
+    }
+  }
+
+  data_t slice(const DateTimeRange& range) const
+  {
+    return concat({{&m_data, lower_index(m_data.first, range.m_TStart),
+                    upper_index(m_data.first, range.m_TEnd)}});
+  }
+
+  DateTimeRange m_range = INVALID_RANGE;
+  data_t m_data;
+  std::size_t m_components;
+  double m_max_span_factor;
+};
@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DataSeriesType.hpp"
+#include "SciQLopCore/Data/Deinterleave.hpp"
+#include "SciQLopCore/Data/TimeSerieView.hpp"
+
+#include <TimeSeries.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Conversions from time series to the planar layout plotted by pipelines.
+ */
+namespace DataConverters
+{
+  /// x axis followed by each component values, one after the other
+  using data_t = std::pair<std::vector<double>, std::vector<double>>;
+
+  /// Works on any sub-range, see the series slice() methods
+  inline data_t view_to_data_t(const TimeSerieView& view)
+  {
+    std::vector<double> x(view.t, view.t + view.size);
+    std::vector<double> y(view.columns * view.size);
+    Deinterleave::deinterleave(view.values, view.size, view.columns,
+                               std::data(y));
+    return {std::move(x), std::move(y)};
+  }
+
+  /// Works on any of TimeSerieTypes, empty if @p ts is null
+  template<typename ts_t> inline data_t to_data_t(const ts_t* ts)
+  {
+    static_assert(std::is_base_of_v<TimeSeries::ITimeSerie, ts_t>);
+    if(ts) return view_to_data_t(ts->view());
+    return {};
+  }
+
+  /// @p ts is expected to be of type TimeSerieOf<dst>, empty otherwise
+  template<DataSeriesType dst>
+  inline data_t to_data_t(TimeSeries::ITimeSerie* ts)
+  {
+    return to_data_t(dynamic_cast<const TimeSerieOf<dst>*>(ts));
+  }
+
+} // namespace DataConverters
@@ -26,6 +26,10 @@
 #include "VectorTimeSerie.hpp"
 
 #include <QString>
+#include <TimeSeries.h>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
 
 enum class DataSeriesType
 {
@@ -36,6 +40,57 @@ enum class DataSeriesType
   SPECTROGRAM
 };
 
+/// Compile time list of time serie types
+template<typename... ts_t> struct TimeSerieTypeList
+{
+  static constexpr std::size_t size = sizeof...(ts_t);
+  template<std::size_t index>
+  using at = std::tuple_element_t<index, std::tuple<ts_t...>>;
+};
+
+/// Every kind of time serie, in DataSeriesType order
+using TimeSerieTypes =
+    TimeSerieTypeList<ScalarTimeSerie, VectorTimeSerie, MultiComponentTimeSerie,
+                      SpectrogramTimeSerie>;
+
+/// DataSeriesType of a time serie type, undefined for unknown types
+template<typename ts_t> struct DataSeriesTypeOf;
+template<>
+struct DataSeriesTypeOf<ScalarTimeSerie>
+    : std::integral_constant<DataSeriesType, DataSeriesType::SCALAR>
+{};
+template<>
+struct DataSeriesTypeOf<VectorTimeSerie>
+    : std::integral_constant<DataSeriesType, DataSeriesType::VECTOR>
+{};
+template<>
+struct DataSeriesTypeOf<MultiComponentTimeSerie>
+    : std::integral_constant<DataSeriesType, DataSeriesType::MULTICOMPONENT>
+{};
+template<>
+struct DataSeriesTypeOf<SpectrogramTimeSerie>
+    : std::integral_constant<DataSeriesType, DataSeriesType::SPECTROGRAM>
+{};
+
+template<typename ts_t>
+inline constexpr DataSeriesType data_series_type_v =
+    DataSeriesTypeOf<ts_t>::value;
+
+/// Time serie type of a DataSeriesType, NONE has none
+template<DataSeriesType ds_type>
+using TimeSerieOf =
+    TimeSerieTypes::at<static_cast<std::size_t>(ds_type) - 1UL>;
+
+/// Carries a time serie type to visitors, see DataSeriesTypeUtils::visit_type
+template<typename ts_t> struct TimeSerieTag
+{
+  using type = ts_t;
+};
+
+static_assert(TimeSerieTypes::size ==
+                  static_cast<std::size_t>(DataSeriesType::SPECTROGRAM),
+              "every DataSeriesType but NONE needs its type in TimeSerieTypes");
+
 struct DataSeriesTypeUtils
 {
   static DataSeriesType fromString(const QString& type)
@@ -58,15 +113,84 @@ struct DataSeriesTypeUtils
     }
     else { return DataSeriesType::NONE; }
   }
+  /**
+   * @brief Kind of @p ts, NONE if it is null or none of TimeSerieTypes.
+   * ITimeSerie carries no tag, this is the only place where series are
+   * identified at runtime, everything else dispatches on the result.
+   */
   static DataSeriesType type(TimeSeries::ITimeSerie* ts)
   {
-    if(!ts) return DataSeriesType::NONE;
-    if(dynamic_cast<ScalarTimeSerie*>(ts)) return DataSeriesType::SCALAR;
-    if(dynamic_cast<VectorTimeSerie*>(ts)) return DataSeriesType::VECTOR;
-    if(dynamic_cast<MultiComponentTimeSerie*>(ts))
-      return DataSeriesType::MULTICOMPONENT;
-    if(dynamic_cast<SpectrogramTimeSerie*>(ts))
-      return DataSeriesType::SPECTROGRAM;
-    return DataSeriesType::NONE;
+    return type(ts, TimeSerieTypes{});
+  }
+
+  /**
+   * @brief Calls @p visitor with TimeSerieTag<ts_t> where ts_t is the time
+   * serie type of @p ds_type.
+   *
+   * The visitor is instantiated for every type of TimeSerieTypes so a type
+   * it can't handle is a compile error. It returns the same type for all of
+   * them, a default constructed one is returned for NONE.
+   */
+  template<typename visitor_t>
+  static auto visit_type(DataSeriesType ds_type, visitor_t&& visitor)
+  {
+    return visit_type(ds_type, visitor, TimeSerieTypes{});
+  }
+
+  /**
+   * @brief Calls @p visitor with @p ts cast to the time serie type of
+   * @p ds_type, without any runtime type check
+   */
+  template<typename visitor_t>
+  static auto visit(DataSeriesType ds_type, TimeSeries::ITimeSerie* ts,
+                    visitor_t&& visitor)
+  {
+    return visit_type(ts ? ds_type : DataSeriesType::NONE,
+                      [ts, &visitor](auto tag) {
+                        using ts_t = typename decltype(tag)::type;
+                        return visitor(static_cast<ts_t*>(ts));
+                      });
+  }
+
+  /// Same as above, @p ts is identified first, see type()
+  template<typename visitor_t>
+  static auto visit(TimeSeries::ITimeSerie* ts, visitor_t&& visitor)
+  {
+    return visit(type(ts), ts, visitor);
+  }
+
+private:
+  template<typename... ts_t>
+  static DataSeriesType type(TimeSeries::ITimeSerie* ts,
+                             TimeSerieTypeList<ts_t...>)
+  {
+    auto result = DataSeriesType::NONE;
+    if(ts)
+      ((dynamic_cast<ts_t*>(ts) ? (result = data_series_type_v<ts_t>, true)
+                                : false) ||
+       ...);
+    return result;
+  }
+
+  template<typename visitor_t, typename... ts_t>
+  static auto visit_type(DataSeriesType ds_type, visitor_t& visitor,
+                         TimeSerieTypeList<ts_t...>)
+  {
+    using result_t = std::invoke_result_t<
+        visitor_t&, TimeSerieTag<TimeSerieTypes::at<0>>>;
+    if constexpr(std::is_void_v<result_t>)
+      ((ds_type == data_series_type_v<ts_t>
+            ? (visitor(TimeSerieTag<ts_t>{}), true)
+            : false) ||
+       ...);
+    else
+    {
+      result_t result{};
+      ((ds_type == data_series_type_v<ts_t>
+            ? (result = visitor(TimeSerieTag<ts_t>{}), true)
+            : false) ||
+       ...);
+      return result;
+    }
   }
 };
@@ -0,0 +1,143 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DateTimeRange.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Decimation
+{
+  using data_t = std::pair<std::vector<double>, std::vector<double>>;
+
+  /**
+   * @brief Splits the time axis into buckets of equal duration.
+   * @return the index of the first sample of each bucket followed by the end
+   * index, empty buckets are skipped
+   */
+  inline std::vector<std::size_t> buckets(const std::vector<double>& x,
+                                          const DateTimeRange& range,
+                                          std::size_t count)
+  {
+    std::vector<std::size_t> result;
+    if(std::empty(x)) return result;
+    const double width = range.delta() / static_cast<double>(count);
+    result.reserve(count + 1);
+    result.push_back(0);
+    auto current = std::floor((x[0] - range.m_TStart) / width);
+    for(auto i = 1UL; i < std::size(x); i++)
+    {
+      if(const auto bucket = std::floor((x[i] - range.m_TStart) / width);
+         bucket != current)
+      {
+        result.push_back(i);
+        current = bucket;
+      }
+    }
+    result.push_back(std::size(x));
+    return result;
+  }
+
+  /**
+   * @brief M4 decimation: keeps for each bucket the first, min, max and last
+   * samples of every component so peaks and drops survive.
+   *
+   * Since all components share the same time axis, each bucket keeps the
+   * union of the samples selected for every component, in time order. Kept
+   * samples are untouched, min and max stay where they occurred.
+   * @param data time axis and components stored one after the other
+   * @param range the displayed range
+   * @param pixels the number of pixel columns used to display range
+   * @return data untouched if it is already small enough, the decimated data
+   * otherwise
+   */
+  inline data_t m4(data_t&& data, const DateTimeRange& range,
+                   std::size_t pixels)
+  {
+    const auto& [x, y] = data;
+    const auto size    = std::size(x);
+    if(pixels == 0 || size <= 4 * pixels || std::isnan(range.m_TStart) ||
+       std::isnan(range.m_TEnd) || !(range.m_TEnd > range.m_TStart))
+      return std::move(data);
+    const auto components = std::size(y) / size;
+    const auto per_bucket = 2 + 2 * components;
+    const auto bounds     = buckets(x, range, pixels);
+    std::vector<std::size_t> kept;
+    kept.reserve(per_bucket * pixels);
+    for(auto b = 0UL; b + 1 < std::size(bounds); b++)
+    {
+      const auto first = bounds[b], last = bounds[b + 1] - 1;
+      const auto bucket_begin = std::size(kept);
+      if(last - first < per_bucket)
+      {
+        for(auto i = first; i <= last; i++)
+          kept.push_back(i);
+        continue;
+      }
+      kept.push_back(first);
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        // NaNs never compare, a bucket of NaNs keeps its first sample
+        const double* values  = y.data() + comp * size;
+        std::size_t min_index = first, max_index = first;
+        auto min = std::numeric_limits<double>::infinity();
+        auto max = -std::numeric_limits<double>::infinity();
+        for(auto i = first; i <= last; i++)
+        {
+          if(values[i] < min)
+          {
+            min       = values[i];
+            min_index = i;
+          }
+          if(values[i] > max)
+          {
+            max       = values[i];
+            max_index = i;
+          }
+        }
+        kept.push_back(min_index);
+        kept.push_back(max_index);
+      }
+      kept.push_back(last);
+      const auto bucket = std::begin(kept) + bucket_begin;
+      std::sort(bucket, std::end(kept));
+      kept.erase(std::unique(bucket, std::end(kept)), std::end(kept));
+    }
+    data_t result;
+    result.first.reserve(std::size(kept));
+    for(const auto i : kept)
+      result.first.push_back(x[i]);
+    result.second.resize(std::size(kept) * components);
+    for(auto comp = 0UL; comp < components; comp++)
+    {
+      const double* values = y.data() + comp * size;
+      double* out          = result.second.data() + comp * std::size(kept);
+      for(const auto i : kept)
+        *out++ = values[i];
+    }
+    return result;
+  }
+
+} // namespace Decimation
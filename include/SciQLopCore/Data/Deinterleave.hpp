@@ -0,0 +1,39 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include <cstddef>
+
+namespace Deinterleave
+{
+  /**
+   * @brief Splits @p size samples of @p components interleaved values
+   * (x0 y0 z0 x1 y1 z1 ...) into one contiguous block per component
+   * (x0 x1 ... y0 y1 ... z0 z1 ...).
+   *
+   * Three components use SSE2 or AVX shuffles, picked at runtime from the CPU
+   * features, any other count goes through a cache blocked scalar transpose.
+   * @param out must have room for size * components values and must not
+   * overlap @p in
+   */
+  void deinterleave(const double* in, std::size_t size, std::size_t components,
+                    double* out);
+} // namespace Deinterleave
@@ -0,0 +1,146 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DataSeriesType.hpp"
+#include "SciQLopCore/Data/TimeSerieView.hpp"
+
+#include <QSaveFile>
+#include <QString>
+#include <QTemporaryFile>
+#include <TimeSeries.h>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class QFile;
+
+/// Everything but the samples of any of the four kinds of series
+struct TimeSerieLayout
+{
+  DataSeriesType type = DataSeriesType::NONE;
+  /// values per sample
+  std::size_t columns = 1;
+  /// spectrogram channels
+  std::vector<double> y;
+  double min_sampling = std::nan("");
+  double max_sampling = std::nan("");
+  bool y_is_log       = true;
+
+  /// Layout of @p ts, any of TimeSerieTypes
+  template<typename ts_t> static TimeSerieLayout of(const ts_t& ts)
+  {
+    TimeSerieLayout layout;
+    layout.type    = data_series_type_v<ts_t>;
+    layout.columns = ts.view().columns;
+    if constexpr(std::is_same_v<ts_t, SpectrogramTimeSerie>)
+    {
+      layout.y            = {std::cbegin(ts.y_axis()), std::cend(ts.y_axis())};
+      layout.min_sampling = ts.min_sampling;
+      layout.max_sampling = ts.max_sampling;
+      layout.y_is_log     = ts.y_is_log;
+    }
+    return layout;
+  }
+
+  inline bool sameShape(const TimeSerieLayout& other) const noexcept
+  {
+    return type == other.type && columns == other.columns && y == other.y;
+  }
+};
+
+/**
+ * @brief Read only time serie whose time axis and values stay in a memory
+ * mapped file, for series larger than RAM.
+ *
+ * Only the pages touched are loaded: slicing a time range binary searches the
+ * mapped time axis and copies the samples within range into a regular time
+ * serie. A provider serving a huge product keeps its MappedTimeSerie and
+ * returns slice() of the requested range from getData, pipelines then only
+ * page in the displayed window.
+ *
+ * Files are written with MappedTimeSerie::Writer: a header, the time axis,
+ * the spectrogram channels if any, then the values row major.
+ */
+class MappedTimeSerie
+{
+public:
+  explicit MappedTimeSerie(const QString& file);
+  MappedTimeSerie(MappedTimeSerie&&) noexcept;
+  MappedTimeSerie& operator=(MappedTimeSerie&&) noexcept;
+  ~MappedTimeSerie();
+
+  /// false if the file is missing, truncated or not a time serie file
+  inline bool isValid() const noexcept { return m_valid; }
+  inline const TimeSerieLayout& layout() const noexcept { return m_layout; }
+  inline std::size_t size() const noexcept { return m_size; }
+  inline const double* time_axis() const noexcept { return m_t; }
+  /// size() * layout().columns doubles, row major
+  inline const double* values() const noexcept { return m_values; }
+
+  /// Every mapped sample, slices of it only page in their samples
+  inline TimeSerieView view() const noexcept
+  {
+    return {m_t, m_values, m_size, m_layout.columns};
+  }
+
+  /// first sample time, NaN if empty
+  inline double start() const noexcept { return view().start(); }
+  /// last sample time, NaN if empty
+  inline double stop() const noexcept { return view().stop(); }
+
+  /// Copies the samples within [@p start, @p stop] into a new time serie
+  TimeSeries::ITimeSerie* slice(double start, double stop) const;
+
+  /// Writes @p ts to @p file, any of the four kinds of series
+  static bool write(const QString& file, TimeSeries::ITimeSerie* ts);
+
+  /**
+   * @brief Writes a time serie file without holding it in memory: samples
+   * are appended in time order, the file only replaces @p file on commit
+   */
+  class Writer
+  {
+  public:
+    Writer(const QString& file, const TimeSerieLayout& layout);
+
+    /// Appends @p count samples, @p values holds count * columns doubles
+    bool append(const double* t, const double* values, std::size_t count);
+    bool commit();
+
+  private:
+    TimeSerieLayout m_layout;
+    QSaveFile m_file;
+    // values are written after the whole time axis
+    QTemporaryFile m_values;
+    quint64 m_size = 0;
+    bool m_ok      = false;
+  };
+
+private:
+  std::unique_ptr<QFile> m_file;
+  TimeSerieLayout m_layout;
+  std::size_t m_size     = 0;
+  const double* m_t      = nullptr;
+  const double* m_values = nullptr;
+  bool m_valid           = false;
+};
@@ -20,6 +20,7 @@
 -- Mail : alexis.jeandet@member.fsf.org
 ----------------------------------------------------------------------------*/
 #pragma once
+#include "SciQLopCore/Data/TimeSerieView.hpp"
 
 #include <TimeSeries.h>
 #include <utility>
@@ -38,6 +39,21 @@ public:
                    .begin());
 
   MultiComponentTimeSerie() {}
+  /// row major values, size(0)*size(1) doubles
+  inline const double* raw_data() const noexcept { return std::data(_data); }
+
+  /// Every sample, see TimeSerieView
+  inline TimeSerieView view() const noexcept
+  {
+    return {std::data(_axes[0]), raw_data(), size(), size(1)};
+  }
+
+  /// Samples within [@p start, @p stop], in O(log n) without copy
+  inline TimeSerieView slice(double start, double stop) const noexcept
+  {
+    return view().slice(start, stop);
+  }
+
   ~MultiComponentTimeSerie() = default;
   using TimeSerie::TimeSerie;
 };
@@ -20,11 +20,15 @@
 -- Mail : alexis.jeandet@member.fsf.org
 ----------------------------------------------------------------------------*/
 #pragma once
+#include "SciQLopCore/Common/ThreadPool.hpp"
 #include "SciQLopCore/DataSource/IDataProvider.hpp"
+#include "SciQLopCore/DataSource/SampleCache.hpp"
 #include "SciQLopCore/GUI/PlotWidget.hpp"
 
 #include <QObject>
 #include <SciQLopPlots/Qt/QCustomPlot/SciQLopPlots.hpp>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 class IPipeline : public QObject
@@ -39,9 +43,31 @@ class Pipelines : QObject
 {
   Q_OBJECT
   std::vector<IPipeline*> m_pipelines;
+  struct InFlightRequest;
+  std::mutex m_inFlightMutex;
+  std::vector<std::shared_ptr<InFlightRequest>> m_inFlight;
+  // serves cacheable providers
+  SampleCache m_sampleCache;
+  // shared by all pipelines to fetch and convert data, declared last so its
+  // queued jobs are drained while everything they use is still alive
+  ThreadPool m_executor;
   void addPipeline(IPipeline*);
 
 public:
   Pipelines(QObject* parent = nullptr);
+  inline ThreadPool& executor() noexcept { return m_executor; }
+
+  /**
+   * @brief Gets data from a provider, identical concurrent requests (same
+   * product, see ProductHandle::id, and range) share a single fetch.
+   *
+   * The shared fetch is only cancelled once every requester cancelled its
+   * request. Cacheable providers are only asked for what isn't in the
+   * sample cache. The returned time serie may be shared between several
+   * requesters and must be treated as read-only.
+   */
+  std::shared_ptr<TimeSeries::ITimeSerie>
+  getData(quint64 productId, IDataProvider* provider,
+          const DataProviderParameters& parameters);
   void plot(const QStringList& products, SciQLopPlots::SciQLopPlot* plot);
 };
@@ -0,0 +1,216 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DateTimeRange.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Regridding
+{
+  /// time axis and channels stored one after the other
+  using data_t = std::pair<std::vector<double>, std::vector<double>>;
+  /// x axis, y axis and values, for each x all the y values are contiguous
+  using grid_t =
+      std::tuple<std::vector<double>, std::vector<double>, std::vector<double>>;
+
+  /**
+   * @brief Computes the centers of @p count cells evenly spaced between
+   * @p min and @p max, in log space when @p log is true
+   */
+  inline std::vector<double> cell_centers(double min, double max,
+                                          std::size_t count, bool log)
+  {
+    std::vector<double> centers(count);
+    if(log)
+    {
+      min = std::log10(min);
+      max = std::log10(max);
+    }
+    const double width = (max - min) / static_cast<double>(count);
+    for(auto i = 0UL; i < count; i++)
+    {
+      centers[i] = min + (static_cast<double>(i) + .5) * width;
+      if(log) centers[i] = std::pow(10., centers[i]);
+    }
+    return centers;
+  }
+
+  /**
+   * @brief For each target cell center, index of the nearest channel of
+   * @p channels (which can be sorted either way)
+   * @return empty when no channel is finite, NaN and infinite channels are
+   * never picked
+   */
+  inline std::vector<std::size_t>
+  nearest_channels(const std::vector<double>& channels,
+                   const std::vector<double>& centers, bool log)
+  {
+    auto scale = [log](double v) { return log ? std::log10(v) : v; };
+    // NaNs would break the sort ordering, they are left out first
+    std::vector<std::size_t> order;
+    order.reserve(std::size(channels));
+    for(auto i = 0UL; i < std::size(channels); i++)
+      if(std::isfinite(channels[i])) order.push_back(i);
+    if(std::empty(order)) return {};
+    std::sort(std::begin(order), std::end(order),
+              [&channels](auto a, auto b) {
+                return channels[a] < channels[b];
+              });
+    std::vector<std::size_t> result(std::size(centers));
+    auto it = std::cbegin(order);
+    for(auto row = 0UL; row < std::size(centers); row++)
+    {
+      const auto v = scale(centers[row]);
+      while(it + 1 != std::cend(order) &&
+            std::abs(scale(channels[*(it + 1)]) - v) <=
+                std::abs(scale(channels[*it]) - v))
+        it++;
+      result[row] = *it;
+    }
+    return result;
+  }
+
+  /**
+   * @brief Resamples a spectrogram onto a regular grid of @p width time cells
+   * and @p height y cells.
+   *
+   * Time cells hold the mean of the samples they contain, NaNs being ignored.
+   * Empty cells closer than @p max_gap from the previous non empty one repeat
+   * its value, so data sampled slower than the grid doesn't look striped.
+   * Y cells take the value of the nearest finite channel. Samples are read
+   * and the grid is written sequentially.
+   * @param data the time axis followed by each channel values
+   * @param y the channels values, one per channel: time dependent channels
+   * give an empty grid and have to be rejected by the caller, so do only non
+   * finite channels
+   * @param range the displayed time range
+   * @param max_gap longest time without samples still considered continuous,
+   * twice the median sampling interval when NaN
+   */
+  inline grid_t regrid(const data_t& data, const std::vector<double>& y,
+                       const DateTimeRange& range, std::size_t width,
+                       std::size_t height, bool y_is_log, double max_gap)
+  {
+    const auto& [x, values] = data;
+    const auto size         = std::size(x);
+    const auto channels     = std::size(y);
+    if(size == 0 || channels == 0 || width == 0 || height == 0 ||
+       std::size(values) != size * channels || !(range.m_TEnd > range.m_TStart))
+      return {};
+    double y_min = std::numeric_limits<double>::infinity();
+    double y_max = -y_min;
+    for(const auto channel : y)
+    {
+      if(std::isfinite(channel))
+      {
+        y_min = std::min(y_min, channel);
+        y_max = std::max(y_max, channel);
+      }
+    }
+    if(y_min > y_max) return {};
+    if(y_is_log && !(y_min > 0.)) y_is_log = false;
+
+    // groups consecutive samples falling in the same time cell
+    const double cell_width = range.delta() / static_cast<double>(width);
+    std::vector<std::size_t> cell_of_group, group_begin;
+    for(auto i = 0UL; i < size; i++)
+    {
+      const auto cell = static_cast<std::size_t>(std::clamp(
+          std::floor((x[i] - range.m_TStart) / cell_width), 0.,
+          static_cast<double>(width - 1)));
+      if(std::empty(cell_of_group) || cell_of_group.back() != cell)
+      {
+        cell_of_group.push_back(cell);
+        group_begin.push_back(i);
+      }
+    }
+    group_begin.push_back(size);
+
+    std::vector<double> columns(channels * width, std::nan(""));
+    for(auto channel = 0UL; channel < channels; channel++)
+    {
+      const double* in = values.data() + channel * size;
+      double* out      = columns.data() + channel * width;
+      for(auto g = 0UL; g < std::size(cell_of_group); g++)
+      {
+        double sum        = 0.;
+        std::size_t count = 0;
+        for(auto i = group_begin[g]; i < group_begin[g + 1]; i++)
+        {
+          const bool valid = !std::isnan(in[i]);
+          sum += valid ? in[i] : 0.;
+          count += valid;
+        }
+        if(count) out[cell_of_group[g]] = sum / static_cast<double>(count);
+      }
+    }
+
+    if(std::isnan(max_gap) && size > 1)
+    {
+      std::vector<double> steps(size);
+      std::adjacent_difference(std::cbegin(x), std::cend(x), std::begin(steps));
+      auto median = std::begin(steps) + 1 + (size - 1) / 2;
+      std::nth_element(std::begin(steps) + 1, median, std::end(steps));
+      max_gap = 2. * *median;
+    }
+
+    // forward fills cells between samples closer than max_gap
+    if(!std::isnan(max_gap))
+    {
+      const auto max_cells =
+          static_cast<std::size_t>(std::ceil(max_gap / cell_width));
+      for(auto g = 1UL; g < std::size(cell_of_group); g++)
+      {
+        const auto previous = cell_of_group[g - 1];
+        const auto gap_end  = cell_of_group[g];
+        if(x[group_begin[g]] - x[group_begin[g] - 1] <= max_gap &&
+           gap_end - previous <= max_cells + 1)
+        {
+          for(auto channel = 0UL; channel < channels; channel++)
+          {
+            double* out = columns.data() + channel * width;
+            std::fill(out + previous + 1, out + gap_end, out[previous]);
+          }
+        }
+      }
+    }
+
+    grid_t result;
+    auto& [grid_x, grid_y, grid_z] = result;
+    grid_x = cell_centers(range.m_TStart, range.m_TEnd, width, false);
+    grid_y = cell_centers(y_min, y_max, height, y_is_log);
+    const auto rows = nearest_channels(y, grid_y, y_is_log);
+    grid_z.resize(width * height);
+    auto out = std::begin(grid_z);
+    for(auto col = 0UL; col < width; col++)
+      for(auto row = 0UL; row < height; row++)
+        *out++ = columns[rows[row] * width + col];
+    return result;
+  }
+
+} // namespace Regridding
@@ -20,6 +20,8 @@
 -- Mail : alexis.jeandet@member.fsf.org
 ----------------------------------------------------------------------------*/
 #pragma once
+#include "SciQLopCore/Data/TimeSerieView.hpp"
+
 #include <TimeSeries.h>
 
 class ScalarTimeSerie : public TimeSeries::TimeSerie<double, ScalarTimeSerie>
@@ -28,4 +30,19 @@ public:
   ScalarTimeSerie() {}
   ~ScalarTimeSerie() = default;
   using TimeSerie::TimeSerie;
+
+  /// size() doubles
+  inline const double* raw_data() const noexcept { return std::data(_data); }
+
+  /// Every sample, see TimeSerieView
+  inline TimeSerieView view() const noexcept
+  {
+    return {std::data(_axes[0]), raw_data(), size(), 1};
+  }
+
+  /// Samples within [@p start, @p stop], in O(log n) without copy
+  inline TimeSerieView slice(double start, double stop) const noexcept
+  {
+    return view().slice(start, stop);
+  }
 };
@@ -20,6 +20,8 @@
 -- Mail : alexis.jeandet@member.fsf.org
 ----------------------------------------------------------------------------*/
 #pragma once
+#include "SciQLopCore/Data/TimeSerieView.hpp"
+
 #include <TimeSeries.h>
 #include <cmath>
 #include <utility>
@@ -46,12 +48,12 @@ public:
                        SpectrogramTimeSerie::data_t&& values,
                        std::vector<std::size_t>& shape, double min_sampling,
                        double max_sampling, bool y_is_log = true)
-      : TimeSeries::TimeSerie<double, SpectrogramTimeSerie, 2>(t, values,
-                                                               shape),
+      : TimeSeries::TimeSerie<double, SpectrogramTimeSerie, 2>(
+            std::move(t), std::move(values), shape),
         min_sampling{min_sampling}, max_sampling{max_sampling}, y_is_log{
                                                                     y_is_log}
   {
-    _axes[1] = y;
+    _axes[1] = std::move(y);
   }
 
   SpectrogramTimeSerie(SpectrogramTimeSerie::axis_t&& t,
@@ -60,12 +62,29 @@ public:
                        const std::initializer_list<std::size_t>& shape,
                        double min_sampling, double max_sampling,
                        bool y_is_log = true)
-      : TimeSeries::TimeSerie<double, SpectrogramTimeSerie, 2>(t, values,
-                                                               shape),
+      : TimeSeries::TimeSerie<double, SpectrogramTimeSerie, 2>(
+            std::move(t), std::move(values), shape),
         min_sampling{min_sampling}, max_sampling{max_sampling}, y_is_log{
                                                                     y_is_log}
   {
-    _axes[1] = y;
+    _axes[1] = std::move(y);
+  }
+
+  inline const axis_t& y_axis() const noexcept { return _axes[1]; }
+
+  /// row major values, size(0)*size(1) doubles
+  inline const double* raw_data() const noexcept { return std::data(_data); }
+
+  /// Every sample, see TimeSerieView, channels are given by y_axis()
+  inline TimeSerieView view() const noexcept
+  {
+    return {std::data(_axes[0]), raw_data(), size(), size(1)};
+  }
+
+  /// Samples within [@p start, @p stop], in O(log n) without copy
+  inline TimeSerieView slice(double start, double stop) const noexcept
+  {
+    return view().slice(start, stop);
   }
 
   ~SpectrogramTimeSerie() = default;
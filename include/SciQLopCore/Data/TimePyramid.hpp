@@ -0,0 +1,391 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/DateTimeRange.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The TimePyramid class keeps min/max/mean aggregates of the samples
+ * already fetched for a product at power of two time resolutions.
+ *
+ * Level L splits time into bins of 2^L seconds grouped in tiles of
+ * bins_per_tile bins. Inserted samples fill every bin they fully cover, from
+ * the finest level worth it (a few samples per bin) up to the coarsest one
+ * with a covered bin, each level being merged from the previous one. Zoomed
+ * out views are then built from the level giving a couple of bins per pixel
+ * column instead of full resolution samples. Least recently used tiles are
+ * dropped once the memory budget is exceeded.
+ */
+class TimePyramid
+{
+public:
+  using data_t = std::pair<std::vector<double>, std::vector<double>>;
+
+  static constexpr std::size_t bins_per_tile = 256;
+
+  enum class Aggregation
+  {
+    /// min and max of each bin, looks like the full resolution samples
+    Envelope,
+    /// mean of each bin at its center
+    Mean
+  };
+
+  /**
+   * @param components number of components per sample
+   * @param budget memory budget in bytes
+   */
+  explicit TimePyramid(std::size_t components, std::size_t budget = 32UL << 20)
+      : m_components{components},
+        m_max_tiles{std::max<std::size_t>(
+            1UL, budget / (bins_per_tile * std::max<std::size_t>(
+                                               1UL, components) *
+                           sizeof(stats_t)))}
+  {}
+
+  /**
+   * @brief Aggregates samples covering @p range, as returned for range by a
+   * provider: bins inside range without samples are gaps, not missing data.
+   * @param data time axis and components stored one after the other
+   */
+  void insert(const data_t& data, const DateTimeRange& range)
+  {
+    const auto& x   = data.first;
+    const auto size = std::size(x);
+    if(size < 2 || std::size(data.second) != size * m_components ||
+       !valid(range))
+      return;
+    const auto period = (x.back() - x.front()) / static_cast<double>(size - 1);
+    if(!(period > 0.)) return;
+    auto level = std::max(
+        level_of(period * min_samples_per_bin),
+        level_of(static_cast<double>(range.delta()) / max_bins_per_insert));
+    if(level > max_level) return;
+    level = std::max(level, min_level);
+    for(auto bins = aggregate(data, range, level);
+        bins.count != 0 && level <= max_level; bins = merge(bins), level++)
+      store(level, bins);
+    evict();
+  }
+
+  /**
+   * @brief Builds the view of @p range for @p pixels columns from tiles
+   * @return an empty optional when the tiles needed aren't all there or the
+   * view needs a finer resolution than the aggregates, samples have to be
+   * fetched
+   */
+  std::optional<data_t> get(const DateTimeRange& range, std::size_t pixels,
+                            Aggregation aggregation = Aggregation::Envelope)
+  {
+    if(pixels == 0 || !valid(range) || std::empty(m_tiles)) return std::nullopt;
+    // 2 to 4 bins per pixel column, or 1 to 2 from the next level
+    const auto seconds_per_pixel =
+        static_cast<double>(range.delta()) / static_cast<double>(pixels);
+    const auto level =
+        static_cast<int>(std::floor(std::log2(seconds_per_pixel / 2.)));
+    for(const auto l : {level, level + 1})
+    {
+      if(l < min_level || l > max_level) continue;
+      if(auto result = view(range, l, aggregation)) return result;
+    }
+    return std::nullopt;
+  }
+
+  inline std::size_t size() const noexcept { return std::size(m_tiles); }
+
+  inline void clear() noexcept
+  {
+    m_index.clear();
+    m_tiles.clear();
+  }
+
+private:
+  static constexpr double min_samples_per_bin = 8.;
+  static constexpr double max_bins_per_insert = 1 << 16;
+  static constexpr int min_level              = -20;
+  static constexpr int max_level              = 40;
+  static constexpr std::int64_t tile_size     = bins_per_tile;
+
+  struct stats_t
+  {
+    double min   = std::numeric_limits<double>::infinity();
+    double max   = -std::numeric_limits<double>::infinity();
+    double sum   = 0.;
+    double count = 0.;
+
+    inline void add(double value) noexcept
+    {
+      if(std::isnan(value)) return;
+      min = std::min(min, value);
+      max = std::max(max, value);
+      sum += value;
+      count++;
+    }
+
+    inline void add(const stats_t& other) noexcept
+    {
+      min = std::min(min, other.min);
+      max = std::max(max, other.max);
+      sum += other.sum;
+      count += other.count;
+    }
+  };
+
+  // consecutive bins of a level, bins.first is a global bin index
+  struct bins_t
+  {
+    std::int64_t first = 0;
+    std::size_t count  = 0;
+    std::vector<stats_t> stats;
+  };
+
+  struct key_t
+  {
+    int level;
+    std::int64_t tile;
+    inline bool operator==(const key_t& other) const noexcept
+    {
+      return level == other.level && tile == other.tile;
+    }
+  };
+
+  struct key_hash
+  {
+    inline std::size_t operator()(const key_t& key) const noexcept
+    {
+      return std::hash<std::int64_t>{}(key.tile * 128 + key.level);
+    }
+  };
+
+  struct tile_t
+  {
+    key_t key;
+    std::vector<stats_t> stats;
+    std::bitset<bins_per_tile> filled;
+  };
+
+  static inline bool valid(const DateTimeRange& range) noexcept
+  {
+    return !std::isnan(range.m_TStart) && !std::isnan(range.m_TEnd) &&
+           range.m_TEnd > range.m_TStart;
+  }
+
+  static inline int level_of(double width) noexcept
+  {
+    return static_cast<int>(std::ceil(std::log2(width)));
+  }
+
+  static inline double bin_width(int level) noexcept
+  {
+    return std::ldexp(1., level);
+  }
+
+  static inline std::int64_t floor_div(std::int64_t a, std::int64_t b) noexcept
+  {
+    auto q = a / b;
+    if((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+  }
+
+  bins_t aggregate(const data_t& data, const DateTimeRange& range,
+                   int level) const
+  {
+    const auto& [x, y] = data;
+    const auto width   = bin_width(level);
+    bins_t bins;
+    // only bins fully covered by range
+    bins.first =
+        static_cast<std::int64_t>(std::ceil(range.m_TStart / width));
+    const auto last =
+        static_cast<std::int64_t>(std::floor(range.m_TEnd / width));
+    if(last <= bins.first) return bins;
+    bins.count = static_cast<std::size_t>(last - bins.first);
+    bins.stats.resize(bins.count * m_components);
+    const auto size = std::size(x);
+    for(auto i = 0UL; i < size; i++)
+    {
+      const auto bin =
+          static_cast<std::int64_t>(std::floor(x[i] / width)) - bins.first;
+      if(bin < 0 || bin >= static_cast<std::int64_t>(bins.count)) continue;
+      auto stats = bins.stats.data() + bin * m_components;
+      for(auto comp = 0UL; comp < m_components; comp++)
+        stats[comp].add(y[comp * size + i]);
+    }
+    return bins;
+  }
+
+  bins_t merge(const bins_t& fine) const
+  {
+    bins_t coarse;
+    // coarse bin b is made of fine bins 2b and 2b+1, both must be there
+    coarse.first   = floor_div(fine.first + 1, 2);
+    const auto end =
+        floor_div(fine.first + static_cast<std::int64_t>(fine.count), 2);
+    if(end <= coarse.first) return coarse;
+    coarse.count = static_cast<std::size_t>(end - coarse.first);
+    coarse.stats.resize(coarse.count * m_components);
+    const auto offset =
+        static_cast<std::size_t>(2 * coarse.first - fine.first) * m_components;
+    for(auto bin = 0UL; bin < coarse.count; bin++)
+    {
+      const auto left  = fine.stats.data() + offset + 2 * bin * m_components;
+      const auto right = left + m_components;
+      auto stats       = coarse.stats.data() + bin * m_components;
+      for(auto comp = 0UL; comp < m_components; comp++)
+      {
+        stats[comp] = left[comp];
+        stats[comp].add(right[comp]);
+      }
+    }
+    return coarse;
+  }
+
+  tile_t* find(const key_t& key)
+  {
+    if(auto it = m_index.find(key); it != std::end(m_index))
+    {
+      m_tiles.splice(std::begin(m_tiles), m_tiles, it->second);
+      return &*it->second;
+    }
+    return nullptr;
+  }
+
+  tile_t& touch(const key_t& key)
+  {
+    if(auto tile = find(key)) return *tile;
+    m_tiles.push_front(
+        tile_t{key, std::vector<stats_t>(bins_per_tile * m_components), {}});
+    m_index[key] = std::begin(m_tiles);
+    return m_tiles.front();
+  }
+
+  void store(int level, const bins_t& bins)
+  {
+    for(auto i = 0UL; i < bins.count;)
+    {
+      const auto bin  = bins.first + static_cast<std::int64_t>(i);
+      const auto tile = floor_div(bin, tile_size);
+      auto& t         = touch({level, tile});
+      for(auto local = static_cast<std::size_t>(bin - tile * tile_size);
+          local < bins_per_tile && i < bins.count; local++, i++)
+      {
+        std::copy_n(bins.stats.data() + i * m_components, m_components,
+                    t.stats.data() + local * m_components);
+        t.filled.set(local);
+      }
+    }
+  }
+
+  void evict()
+  {
+    while(std::size(m_tiles) > m_max_tiles)
+    {
+      m_index.erase(m_tiles.back().key);
+      m_tiles.pop_back();
+    }
+  }
+
+  std::optional<data_t> view(const DateTimeRange& range, int level,
+                             Aggregation aggregation)
+  {
+    const auto width = bin_width(level);
+    const auto first =
+        static_cast<std::int64_t>(std::floor(range.m_TStart / width));
+    const auto last =
+        static_cast<std::int64_t>(std::ceil(range.m_TEnd / width));
+    std::vector<std::pair<std::int64_t, const stats_t*>> bins;
+    bins.reserve(static_cast<std::size_t>(last - first));
+    tile_t* tile = nullptr;
+    for(auto bin = first; bin < last; bin++)
+    {
+      const auto tile_index = floor_div(bin, tile_size);
+      if(!tile || tile->key.tile != tile_index)
+        tile = find({level, tile_index});
+      const auto local = static_cast<std::size_t>(bin - tile_index * tile_size);
+      if(tile && tile->filled.test(local))
+      {
+        const auto stats = tile->stats.data() + local * m_components;
+        if(std::any_of(stats, stats + m_components,
+                       [](const auto& s) { return s.count > 0.; }))
+          bins.emplace_back(bin, stats);
+      }
+      // bins partially outside range may be missing, they were at the edge
+      // of a fetched range too
+      else if(bin != first && bin != last - 1)
+        return std::nullopt;
+    }
+    const auto points_per_bin =
+        aggregation == Aggregation::Envelope ? 2UL : 1UL;
+    const auto count = std::size(bins) * points_per_bin;
+    data_t result;
+    result.first.reserve(count);
+    for(const auto& [bin, _] : bins)
+    {
+      const auto start = static_cast<double>(bin) * width;
+      if(aggregation == Aggregation::Envelope)
+      {
+        result.first.push_back(start + width / 4.);
+        result.first.push_back(start + 3. * width / 4.);
+      }
+      else
+        result.first.push_back(start + width / 2.);
+    }
+    result.second.resize(count * m_components);
+    for(auto comp = 0UL; comp < m_components; comp++)
+    {
+      auto out = result.second.data() + comp * count;
+      for(const auto& [_, stats] : bins)
+      {
+        const auto& s = stats[comp];
+        if(s.count == 0.)
+        {
+          std::fill_n(out, points_per_bin, std::nan(""));
+          out += points_per_bin;
+        }
+        else if(aggregation == Aggregation::Envelope)
+        {
+          *out++ = s.min;
+          *out++ = s.max;
+        }
+        else
+          *out++ = s.sum / s.count;
+      }
+    }
+    return result;
+  }
+
+  std::size_t m_components;
+  std::size_t m_max_tiles;
+  // most recently used first
+  std::list<tile_t> m_tiles;
+  std::unordered_map<key_t, std::list<tile_t>::iterator, key_hash> m_index;
+};
@@ -0,0 +1,166 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include "SciQLopCore/Data/MappedTimeSerie.hpp"
+#include "SciQLopCore/Data/MultiComponentTimeSerie.hpp"
+#include "SciQLopCore/Data/ScalarTimeSerie.hpp"
+#include "SciQLopCore/Data/SpectrogramTimeSerie.hpp"
+#include "SciQLopCore/Data/TimeSerieView.hpp"
+#include "SciQLopCore/Data/VectorTimeSerie.hpp"
+
+#include <TimeSeries.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Stitching of adjacent chunks of a time serie: overlapping samples are
+ * dropped first, so the result is allocated once at its final size and each
+ * kept sample is copied exactly once.
+ */
+namespace TimeSeriesUtils
+{
+  /**
+   * @brief Trims in place chunks given in time order, the samples of a chunk
+   * which aren't after the last sample kept from the previous ones are
+   * dropped (first chunk wins on overlaps and duplicates)
+   * @return the number of samples left
+   */
+  inline std::size_t trim_overlaps(std::vector<TimeSerieView>& chunks)
+  {
+    std::size_t size = 0;
+    const double* last = nullptr;
+    for(auto& chunk : chunks)
+    {
+      if(last != nullptr && !chunk.empty())
+      {
+        const auto first =
+            static_cast<std::size_t>(
+                std::upper_bound(chunk.t, chunk.t + chunk.size, *last) -
+                chunk.t);
+        chunk = {chunk.t + first, chunk.row(first), chunk.size - first,
+                 chunk.columns};
+      }
+      if(!chunk.empty())
+      {
+        last = chunk.t + chunk.size - 1;
+        size += chunk.size;
+      }
+    }
+    return size;
+  }
+
+  /**
+   * @brief Copies trimmed @p chunks back to back into @p t and @p values,
+   * @p t can be null to only copy values
+   */
+  inline void copy_chunks(const std::vector<TimeSerieView>& chunks, double* t,
+                          double* values)
+  {
+    for(const auto& chunk : chunks)
+    {
+      if(chunk.empty()) continue;
+      if(t != nullptr)
+      {
+        std::memcpy(t, chunk.t, chunk.size * sizeof(double));
+        t += chunk.size;
+      }
+      std::memcpy(values, chunk.values,
+                  chunk.size * chunk.columns * sizeof(double));
+      values += chunk.size * chunk.columns;
+    }
+  }
+
+  /**
+   * @brief Stitches @p chunks, given in time order, into a new ts_t shaped
+   * as @p layout: one allocation per buffer and one copy pass, whatever the
+   * number of chunks
+   */
+  template<typename ts_t>
+  std::unique_ptr<ts_t> merge(std::vector<TimeSerieView> chunks,
+                              const TimeSerieLayout& layout)
+  {
+    using value_t = typename ts_t::raw_value_type;
+    for(const auto& chunk : chunks)
+      if(!chunk.empty() && chunk.columns != layout.columns) return nullptr;
+    const auto size = trim_overlaps(chunks);
+    std::vector<double> t(size);
+    std::vector<value_t> values(size * layout.columns * sizeof(double) /
+                                sizeof(value_t));
+    copy_chunks(chunks, std::data(t),
+                reinterpret_cast<double*>(std::data(values)));
+    if constexpr(std::is_same_v<ts_t, SpectrogramTimeSerie>)
+      return std::make_unique<ts_t>(
+          std::move(t), std::vector<double>{layout.y}, std::move(values),
+          std::initializer_list<std::size_t>{size, layout.columns},
+          layout.min_sampling, layout.max_sampling, layout.y_is_log);
+    else if constexpr(std::is_same_v<ts_t, MultiComponentTimeSerie>)
+      return std::make_unique<ts_t>(
+          std::move(t), std::move(values),
+          std::initializer_list<std::size_t>{size, layout.columns});
+    else
+      return std::make_unique<ts_t>(std::move(t), std::move(values));
+  }
+
+  /// Same as above for any of TimeSerieTypes, nullptr if NONE
+  inline TimeSeries::ITimeSerie* merge(std::vector<TimeSerieView> chunks,
+                                       const TimeSerieLayout& layout)
+  {
+    return DataSeriesTypeUtils::visit_type(
+        layout.type, [&](auto tag) -> TimeSeries::ITimeSerie* {
+          using ts_t = typename decltype(tag)::type;
+          return merge<ts_t>(std::move(chunks), layout).release();
+        });
+  }
+
+  /**
+   * @brief Stitches time series chunks in any order, they are sorted by start
+   * time first. The only chunk left after trimming is moved as is.
+   * @return nullptr if chunks don't share the same shape
+   */
+  template<typename ts_t>
+  std::unique_ptr<ts_t> merge(std::vector<std::unique_ptr<ts_t>>&& chunks)
+  {
+    chunks.erase(std::remove_if(std::begin(chunks), std::end(chunks),
+                                [](const auto& c) { return !c || !c->size(); }),
+                 std::end(chunks));
+    if(std::empty(chunks)) return nullptr;
+    std::stable_sort(std::begin(chunks), std::end(chunks),
+                     [](const auto& a, const auto& b) {
+                       return a->view().t[0] < b->view().t[0];
+                     });
+    const auto layout = TimeSerieLayout::of(*chunks.front());
+    std::vector<TimeSerieView> views;
+    views.reserve(std::size(chunks));
+    for(const auto& chunk : chunks)
+    {
+      if(!layout.sameShape(TimeSerieLayout::of(*chunk))) return nullptr;
+      views.push_back(chunk->view());
+    }
+    const auto size = trim_overlaps(views);
+    if(size == chunks.front()->size()) return std::move(chunks.front());
+    return merge<ts_t>(std::move(views), layout);
+  }
+
+} // namespace TimeSeriesUtils
@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Non owning view over consecutive samples of a time serie: its time
+ * axis and its values, row major, whatever the kind of serie.
+ *
+ * Views are only valid as long as the viewed serie is alive and unchanged.
+ */
+struct TimeSerieView
+{
+  const double* t      = nullptr;
+  /// size * columns values
+  const double* values = nullptr;
+  std::size_t size     = 0;
+  /// values per sample
+  std::size_t columns  = 1;
+
+  inline bool empty() const noexcept { return size == 0; }
+
+  inline const double* row(std::size_t index) const noexcept
+  {
+    return values + index * columns;
+  }
+
+  /// first sample time, NaN if empty
+  inline double start() const noexcept
+  {
+    return empty() ? std::nan("") : t[0];
+  }
+
+  /// last sample time, NaN if empty
+  inline double stop() const noexcept
+  {
+    return empty() ? std::nan("") : t[size - 1];
+  }
+
+  /**
+   * @brief Samples within [@p start, @p stop], bounds included, found by
+   * binary search on the time axis
+   */
+  inline TimeSerieView slice(double start, double stop) const noexcept
+  {
+    const auto first = std::lower_bound(t, t + size, start);
+    const auto last =
+        std::max(first, std::upper_bound(first, t + size, stop));
+    const auto offset = static_cast<std::size_t>(first - t);
+    return {first, values + offset * columns,
+            static_cast<std::size_t>(last - first), columns};
+  }
+};
@@ -21,58 +21,49 @@
 ----------------------------------------------------------------------------*/
 #pragma once
 
-#include "MultiComponentTimeSerie.h"
-#include "ScalarTimeSerie.h"
-#include "SpectrogramTimeSerie.h"
-#include "VectorTimeSerie.h"
+#include "DataSeriesType.hpp"
+#include "MultiComponentTimeSerie.hpp"
+#include "ScalarTimeSerie.hpp"
+#include "SpectrogramTimeSerie.hpp"
+#include "TimeSerieView.hpp"
+#include "VectorTimeSerie.hpp"
 
 #include <TimeSeries.h>
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
 namespace TimeSeriesUtils
 {
+  /// Copy of @p input_ts, a raw or shared pointer, nullptr if unknown
   template<typename T> TimeSeries::ITimeSerie* copy(T input_ts)
   {
-    if constexpr(std::is_base_of_v<TimeSeries::ITimeSerie, T>)
-    {
-      if(auto ts = dynamic_cast<VectorTimeSerie*>(input_ts))
-      {
-        return new VectorTimeSerie(*ts);
-      }
-      if(auto ts = dynamic_cast<ScalarTimeSerie*>(input_ts))
-      {
-        return new ScalarTimeSerie(*ts);
-      }
-      if(auto ts = dynamic_cast<MultiComponentTimeSerie*>(input_ts))
-      {
-        return new MultiComponentTimeSerie(*ts);
-      }
-      if(auto ts = dynamic_cast<SpectrogramTimeSerie*>(input_ts))
-      {
-        return new SpectrogramTimeSerie(*ts);
-      }
-    }
+    TimeSeries::ITimeSerie* ts = nullptr;
+    if constexpr(std::is_pointer_v<T>)
+      ts = input_ts;
     else
-    {
-      if(auto ts = std::dynamic_pointer_cast<VectorTimeSerie>(input_ts))
-      {
-        return new VectorTimeSerie(*ts);
-      }
-      if(auto ts = std::dynamic_pointer_cast<ScalarTimeSerie>(input_ts))
-      {
-        return new ScalarTimeSerie(*ts);
-      }
-      if(auto ts = std::dynamic_pointer_cast<SpectrogramTimeSerie>(input_ts))
-      {
-        return new SpectrogramTimeSerie(*ts);
-      }
-      if(auto ts = std::dynamic_pointer_cast<MultiComponentTimeSerie>(input_ts))
-      {
-        return new MultiComponentTimeSerie(*ts);
-      }
-    }
-    return nullptr;
+      ts = input_ts.get();
+    return DataSeriesTypeUtils::visit(
+        ts, [](auto* serie) -> TimeSeries::ITimeSerie* {
+          return new std::remove_pointer_t<decltype(serie)>(*serie);
+        });
+  }
+
+  /// Every sample of @p ts, empty if unknown, see TimeSerieView
+  inline TimeSerieView view(TimeSeries::ITimeSerie* ts)
+  {
+    return DataSeriesTypeUtils::visit(
+        ts, [](auto* serie) { return serie->view(); });
+  }
+
+  /// Samples of @p ts within [@p start, @p stop], in O(log n) without copy
+  inline TimeSerieView slice(TimeSeries::ITimeSerie* ts, double start,
+                             double stop)
+  {
+    return view(ts).slice(start, stop);
   }
 
   struct axis_properties
@@ -41,6 +41,7 @@
 -- Mail : alexis.jeandet@member.fsf.org
 ----------------------------------------------------------------------------*/
 #pragma once
+#include "SciQLopCore/Data/TimeSerieView.hpp"
 
 #include <TimeSeries.h>
 
@@ -48,6 +49,8 @@ struct Vector
 {
   double x, y, z;
 };
+static_assert(sizeof(Vector) == 3 * sizeof(double),
+              "Vector samples must be packed x,y,z doubles");
 
 class VectorTimeSerie : public TimeSeries::TimeSerie<Vector, VectorTimeSerie>
 {
@@ -55,4 +58,22 @@ public:
   VectorTimeSerie() {}
   ~VectorTimeSerie() = default;
   using TimeSerie::TimeSerie;
+
+  /// interleaved x,y,z values, 3*size() doubles
+  inline const double* raw_data() const noexcept
+  {
+    return reinterpret_cast<const double*>(std::data(_data));
+  }
+
+  /// Every sample, see TimeSerieView
+  inline TimeSerieView view() const noexcept
+  {
+    return {std::data(_axes[0]), raw_data(), size(), 3};
+  }
+
+  /// Samples within [@p start, @p stop], in O(log n) without copy
+  inline TimeSerieView slice(double start, double stop) const noexcept
+  {
+    return view().slice(start, stop);
+  }
 };
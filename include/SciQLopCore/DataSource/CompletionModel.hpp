@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include <QAbstractListModel>
+#include <QSet>
+#include <QString>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Sorted and deduplicated list of completion strings.
+ *
+ * Strings are kept sorted case insensitively so QCompleter can use
+ * QCompleter::CaseInsensitivelySortedModel and binary search instead of
+ * scanning every row. New strings are merged in with beginInsertRows() per
+ * contiguous run, large scattered batches fall back to a single layout change,
+ * the model is never reset.
+ */
+class CompletionModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  explicit CompletionModel(QObject* parent = nullptr);
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index,
+                int role = Qt::DisplayRole) const override;
+
+  void insert(const QSet<QString>& strings);
+
+  /// Rows [first, last) of the strings starting with @p prefix, case
+  /// insensitively
+  std::pair<int, int> prefixRange(const QString& prefix) const;
+
+private:
+  std::vector<QString> m_strings;
+};
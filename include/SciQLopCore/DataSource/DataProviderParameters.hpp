@@ -23,6 +23,84 @@
 #include "SciQLopCore/Data/DateTimeRange.hpp"
 
 #include <QVariantHash>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The CancellationToken class is shared between a request emitter and
+ * the data provider serving it. The emitter cancels it when the request gets
+ * superseded (for example by a newer range), long running providers should
+ * check it and abort as soon as possible.
+ * Copies of a token share the same state.
+ */
+class CancellationToken
+{
+  using callback_t = std::pair<std::size_t, std::function<void()>>;
+  struct state_t
+  {
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    std::size_t next_id = 1;
+    std::vector<callback_t> callbacks;
+  };
+  std::shared_ptr<state_t> m_state = std::make_shared<state_t>();
+
+public:
+  inline void cancel()
+  {
+    std::vector<callback_t> callbacks;
+    {
+      std::lock_guard<std::mutex> lock{m_state->mutex};
+      if(m_state->cancelled.exchange(true)) return;
+      std::swap(callbacks, m_state->callbacks);
+    }
+    for(const auto& callback : callbacks)
+      callback.second();
+  }
+
+  inline bool cancelled() const noexcept { return m_state->cancelled.load(); }
+
+  /**
+   * @brief Registers a callback called once the token gets cancelled, or
+   * immediately if it already is. Callbacks must be short and non blocking.
+   * @return an id for removeOnCancel, 0 if the callback was already called
+   */
+  inline std::size_t onCancel(std::function<void()> callback) const
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_state->mutex};
+      if(!m_state->cancelled)
+      {
+        const auto id = m_state->next_id++;
+        m_state->callbacks.emplace_back(id, std::move(callback));
+        return id;
+      }
+    }
+    callback();
+    return 0;
+  }
+
+  /**
+   * @brief Drops a callback once it is no longer needed, tokens may live much
+   * longer than the requests registering callbacks on them. A callback
+   * already running because of a concurrent cancel() isn't waited for.
+   */
+  inline void removeOnCancel(std::size_t id) const
+  {
+    std::lock_guard<std::mutex> lock{m_state->mutex};
+    auto& callbacks = m_state->callbacks;
+    callbacks.erase(std::remove_if(std::begin(callbacks), std::end(callbacks),
+                                   [id](const auto& callback) {
+                                     return callback.first == id;
+                                   }),
+                    std::end(callbacks));
+  }
+};
 
 /**
  * @brief The DataProviderParameters struct holds the information needed to
@@ -35,4 +113,6 @@ struct DataProviderParameters
   DateTimeRange m_Range;
   /// Extra data that can be used by the provider to retrieve data
   QVariantHash m_Data;
+  /// Cancelled when the request is no longer needed
+  CancellationToken m_Cancellation;
 };
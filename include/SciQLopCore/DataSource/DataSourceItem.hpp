@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <cpp_utils/trees/algorithms.hpp>
 #include <cpp_utils/containers/algorithms.hpp>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -98,6 +99,12 @@ public:
 
   void removeChild(DataSourceItem *child) noexcept;
 
+  /**
+   * Removes (and deletes) @p count children starting at @p first, the
+   * remaining children keep their order
+   */
+  void removeChildren(int first, int count) noexcept;
+
   /**
    * Returns the item's child associated to an index
    * @param childIndex the index to search
@@ -119,6 +126,15 @@ public:
   /// Gets all data
   QVariantHash data() const noexcept;
 
+  /**
+   * @brief Gets all data as a shared immutable snapshot, taken at each call
+   * so items don't pay for it
+   */
+  std::shared_ptr<const QVariantHash> sharedData() const noexcept;
+
+  /// Unique id of the item for the whole application run, never reused
+  quint64 id() const noexcept;
+
   /**
    * Merge in the item the source item passed as parameter.
    *
@@ -172,6 +188,13 @@ public:
   QString icon() const noexcept;
   void setIcon(const QString& iconName);
   QString path() const noexcept;
+
+  /**
+   * A lazy folder has children its provider hasn't registered yet, they are
+   * requested when the folder is expanded
+   */
+  bool isLazy() const noexcept;
+  void setLazy(bool lazy) noexcept;
   DataSeriesType dataSeriesType()const noexcept;
 
   /**
@@ -196,6 +219,26 @@ public:
   void setData(const QString& key, const QVariant& value,
                bool append = false) noexcept;
 
+  /**
+   * @brief Replaces the series type, metadata and provider of a product
+   * registered again, the name is kept
+   */
+  void setProduct(DataSeriesType ds_type, const QVariantHash& data,
+                  const QString& sourceUUID) noexcept;
+
+  /**
+   * @brief Sets the function called with the changed item whenever setData()
+   * or setProduct() is called on this item or any of its descendants
+   */
+  void setDataChangedCallback(
+      std::function<void(const DataSourceItem*)> callback) noexcept;
+
+  /**
+   * @brief Case insensitive substring search in the item name and metadata
+   * values, without copying them
+   */
+  bool containsText(const QString& text) const noexcept;
+
   DataSourceItemType type() const noexcept;
 
   /**
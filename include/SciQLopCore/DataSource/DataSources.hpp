@@ -23,14 +23,33 @@
 #pragma once
 
 #include "DataSourceItem.hpp"
+#include "SciQLopCore/DataSource/CompletionModel.hpp"
 #include "SciQLopCore/Common/SciQLopObject.hpp"
 #include "SciQLopCore/Common/Product.hpp"
 #include "SciQLopCore/DataSource/IDataProvider.hpp"
+#include "SciQLopCore/DataSource/InventoryCache.hpp"
+#include "SciQLopCore/DataSource/ProductsIndex.hpp"
 
 #include <QAbstractItemModel>
 #include <QMimeData>
 #include <QObject>
-#include <QStringListModel>
+#include <memory>
+
+/**
+ * @brief Everything needed to fetch and plot a product, resolved at once from
+ * its path by DataSources::resolve.
+ */
+struct ProductHandle
+{
+  IDataProvider* provider       = nullptr;
+  DataSeriesType dataSeriesType = DataSeriesType::NONE;
+  std::shared_ptr<const QVariantHash> metaData;
+  /// stable as long as the product stays in the tree, never reused, keys
+  /// the fetches shared by Pipelines::getData
+  quint64 id = 0;
+
+  inline bool isValid() const noexcept { return provider != nullptr; }
+};
 
 class DataSources : public QAbstractItemModel, public SciQLopObject
 {
@@ -66,6 +85,32 @@ public:
 
   void addProducts(const QString &providerUid,const QVector<Product*>& products);
 
+  /**
+   * @brief Registers folders whose content is only requested from the
+   * provider (see IDataProvider::fetchProducts) once they get expanded, so
+   * large inventories don't have to be loaded up front
+   */
+  void addLazyFolders(const QString& providerUid, const QStringList& paths);
+
+  /**
+   * @brief Registers the inventory snapshot saved for @p providerUid, if it
+   * was saved with the same @p version token, in one batch. The provider then
+   * only has to register (or remove) what changed since.
+   * @return false when there is no usable snapshot, the provider has to
+   * register its whole inventory
+   */
+  bool loadInventory(const QString& providerUid, const QString& version);
+
+  /// Paths of the products registered by @p providerUid
+  QStringList products(const QString& providerUid) const;
+
+  /// Saves everything @p providerUid registered so far, see loadInventory
+  bool saveInventory(const QString& providerUid, const QString& version) const;
+
+  bool hasChildren(const QModelIndex& parent) const final;
+  bool canFetchMore(const QModelIndex& parent) const final;
+  void fetchMore(const QModelIndex& parent) final;
+
   void removeDataSourceItems(const QStringList& paths) noexcept;
 
   template<typename data_provider_t, class... Args>
@@ -84,22 +129,43 @@ public:
 
   void setIcon(const QString& path, const QString& iconName);
 
-  inline QStringListModel* completionModel() const noexcept
+  inline CompletionModel* completionModel() const noexcept
   {
     return _completionModel;
   }
 
   IDataProvider* provider(const QString& path);
 
+  /**
+   * @brief Resolves a product path with a single tree walk
+   * @return an invalid handle if the path isn't a product with a registered
+   * provider
+   */
+  ProductHandle resolve(const QString& path);
+
+  /**
+   * @brief Case insensitive substring search over item names and metadata
+   * values, served from an index kept up to date as items come and go
+   * @return every matching item, folders included
+   */
+  QSet<const DataSourceItem*> search(const QString& query) const;
+
   DataSeriesType dataSeriesType(const QString& path);
 
   QVariantHash nodeData(const QString& path);
 
 private:
-  void _updateCompletionModel(const QSet<QString> new_data);
+  class PendingItems;
+  void _insertPendingItems(PendingItems& pending);
+  void _removeItems(const std::vector<DataSourceItem*>& items);
+  void _untrack(DataSourceItem* item);
+  IDataProvider* _provider(const DataSourceItem* node) const;
   DataSourceItem* _root=nullptr;
   std::map<QString, IDataProvider*> _DataProviders;
-  std::map<QString, QStringList> _Products;
+  // items registered by each provider, so unloading one doesn't walk paths
+  std::map<QString, QSet<DataSourceItem*>> _ProviderItems;
   QHash<QString, QVariant> _icons;
-  QStringListModel* _completionModel=nullptr;
+  CompletionModel* _completionModel=nullptr;
+  ProductsIndex _index;
+  InventoryCache _inventoryCache;
 };
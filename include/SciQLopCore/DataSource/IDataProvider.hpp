@@ -60,9 +60,38 @@ public:
         "You must implement IDataProvider::getData method"};
   }
 
+  /**
+   * @brief Called when a lazy folder registered by this provider with
+   * DataSources::addLazyFolders is expanded, the provider is expected to
+   * register the folder content (products and/or lazy sub-folders).
+   * @param path the folder path
+   */
+  inline virtual void fetchProducts(const QString& path) { (void)path; }
+
+  /**
+   * @brief Results of cacheable providers are kept on disk across sessions
+   * (see SampleCache), meant for providers serving immutable remote data
+   */
+  inline bool cacheable() const noexcept { return m_cacheable; }
+  inline void setCacheable(bool cacheable) noexcept { m_cacheable = cacheable; }
+
+  /**
+   * @brief Seconds after which ended periods are considered complete and get
+   * stored by SampleCache, remote archives often ingest recent data late
+   */
+  inline double cacheSettleDelay() const noexcept { return m_cacheSettleDelay; }
+  inline void setCacheSettleDelay(double seconds) noexcept
+  {
+    m_cacheSettleDelay = seconds;
+  }
+
 signals:
 
   void progress(QUuid requestID, double progress);
+
+private:
+  bool m_cacheable          = false;
+  double m_cacheSettleDelay = 3. * 86400.;
 };
 
 // Required for using shared_ptr in signals/slots
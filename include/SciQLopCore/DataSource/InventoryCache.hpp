@@ -0,0 +1,83 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include "SciQLopCore/Data/DataSeriesType.hpp"
+
+#include <QMap>
+#include <QString>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Versioned binary snapshots of provider inventories.
+ *
+ * A snapshot holds every item a provider registered (paths, series types and
+ * metadata) behind a string table, so repeated keys and folder names are
+ * stored and decoded once. Snapshots are keyed by provider name and tagged
+ * with a provider supplied version token, any mismatch (token, format,
+ * truncated or corrupted file) makes the snapshot unusable. Files are memory
+ * mapped and read in a single pass.
+ */
+class InventoryCache
+{
+public:
+  enum class EntryKind : quint8
+  {
+    Product,
+    Folder,
+    LazyFolder
+  };
+
+  struct Entry
+  {
+    EntryKind kind                = EntryKind::Product;
+    DataSeriesType dataSeriesType = DataSeriesType::NONE;
+    QString path;
+    QMap<QString, QString> metaData;
+  };
+
+  explicit InventoryCache(const QString& directory = defaultDirectory());
+
+  /// Subdirectory of the user cache location
+  static QString defaultDirectory();
+
+  QString fileName(const QString& provider) const;
+
+  /**
+   * @brief Calls @p visit with each entry of the snapshot saved for
+   * @p provider, the entry is reused between calls
+   * @return false if there is no snapshot matching @p version, @p visit may
+   * already have been called when a corrupted snapshot is detected late
+   */
+  bool load(const QString& provider, const QString& version,
+            const std::function<void(const Entry&)>& visit) const;
+
+  /// Atomically replaces the snapshot saved for @p provider
+  bool save(const QString& provider, const QString& version,
+            const std::vector<Entry>& entries) const;
+
+  bool remove(const QString& provider) const;
+
+private:
+  QString m_directory;
+};
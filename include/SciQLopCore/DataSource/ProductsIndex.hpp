@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <vector>
+
+class DataSourceItem;
+
+/**
+ * @brief Trigram index over item names and metadata values.
+ *
+ * Answers case insensitive substring queries without walking the tree:
+ * candidates come from the intersection of the query trigrams posting lists
+ * and are then checked against the item metadata, no copy of the indexed text
+ * is kept. Removed and updated items leave holes which are compacted once
+ * they outnumber live items.
+ */
+class ProductsIndex
+{
+public:
+  /// Indexes @p item and its whole subtree
+  void add(const DataSourceItem* item);
+  /// Removes @p item and its whole subtree from the index
+  void remove(const DataSourceItem* item);
+  /// Indexes again @p item alone, after its metadata changed
+  void update(const DataSourceItem* item);
+  QSet<const DataSourceItem*> search(const QString& query) const;
+  inline std::size_t size() const noexcept { return std::size(m_slots); }
+
+private:
+  using trigram_t = quint64;
+  void index(const DataSourceItem* item);
+  void unindex(const DataSourceItem* item);
+  bool release(const DataSourceItem* item);
+  void compact();
+
+  // slot -> item, nullptr once removed
+  std::vector<const DataSourceItem*> m_items;
+  QHash<const DataSourceItem*, quint32> m_slots;
+  // sorted slots of the items containing each trigram
+  QHash<trigram_t, std::vector<quint32>> m_postings;
+  std::size_t m_removed = 0;
+};
@@ -0,0 +1,94 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include "SciQLopCore/DataSource/DataProviderParameters.hpp"
+
+#include <QHash>
+#include <QString>
+#include <TimeSeries.h>
+#include <list>
+#include <mutex>
+
+class IDataProvider;
+
+/**
+ * @brief Disk cache of provider results, shared across sessions.
+ *
+ * Time is split into fixed duration buckets (one day by default) and each
+ * bucket of a product is stored as one columnar chunk file: a small header,
+ * the time axis then the values, row major. Products are identified by their
+ * provider and metadata. A request reads the buckets already on disk and only
+ * fetches the missing ones, consecutive missing buckets going through a
+ * single provider call. Buckets which aren't over yet, or ended less than
+ * the provider IDataProvider::cacheSettleDelay() ago, are never stored since
+ * their content may still change, they are only fetched over the requested
+ * range. When a whole bucket fetch fails its requested part is fetched
+ * again, uncached.
+ *
+ * Least recently used chunks are removed once the disk budget is exceeded,
+ * chunks modification times keep track of their last use across sessions.
+ */
+class SampleCache
+{
+public:
+  /**
+   * @param directory where chunks are stored
+   * @param budget disk budget in bytes
+   * @param bucket bucket duration in seconds
+   */
+  explicit SampleCache(const QString& directory = defaultDirectory(),
+                       qint64 budget = 4LL << 30, double bucket = 86400.);
+
+  /// Subdirectory of the user cache location
+  static QString defaultDirectory();
+
+  /**
+   * @brief Same contract as IDataProvider::getData, @p provider is only
+   * called for the buckets missing on disk
+   */
+  TimeSeries::ITimeSerie* getData(IDataProvider* provider,
+                                  const DataProviderParameters& parameters);
+
+  /// Disk space used by chunks, in bytes
+  qint64 size();
+
+  void clear();
+
+private:
+  QString chunkFile(const QString& product, qint64 bucket) const;
+  bool contains(const QString& file);
+  void touched(const QString& file);
+  void added(const QString& file, qint64 size);
+  void removed(const QString& file);
+  void evict();
+
+  QString m_directory;
+  qint64 m_budget;
+  double m_bucket;
+
+  std::mutex m_mutex;
+  qint64 m_size = 0;
+  // chunk files, most recently used first
+  std::list<QString> m_lru;
+  QHash<QString, std::pair<std::list<QString>::iterator, qint64>> m_chunks;
+};
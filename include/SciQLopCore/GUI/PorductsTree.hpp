@@ -22,9 +22,9 @@
 #pragma once
 
 #include <QWidget>
-#include <QSortFilterProxyModel>
 
 #include "SciQLopCore/Common/SciQLopObject.hpp"
+#include "SciQLopCore/GUI/ProductsFilterModel.hpp"
 
 namespace Ui
 {
@@ -43,7 +43,7 @@ private:
     void updateTreeWidget() noexcept;
 
     Ui::ProductsTree* ui;
-    QSortFilterProxyModel m_model_proxy;
+    ProductsFilterModel m_model_proxy;
 
 };
 
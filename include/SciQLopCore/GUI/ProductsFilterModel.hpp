@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QTimer>
+
+class DataSourceItem;
+class DataSources;
+
+/**
+ * @brief Filters the products tree with DataSources::search.
+ *
+ * Rows are kept when they match the query, lead to a match or sit below a
+ * matching folder. Each check is a hash lookup per ancestor and only rows the
+ * view asks for get checked, instead of recursively filtering the whole tree
+ * on every keystroke. Tree changes are coalesced into one refresh per event
+ * loop iteration, and ignored while there is no query.
+ */
+class ProductsFilterModel : public QSortFilterProxyModel
+{
+  Q_OBJECT
+
+public:
+  explicit ProductsFilterModel(QObject* parent = nullptr);
+  void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+public slots:
+  void setQuery(const QString& query);
+
+protected:
+  bool filterAcceptsRow(int source_row,
+                        const QModelIndex& source_parent) const override;
+
+private:
+  void scheduleRefresh();
+  void refresh();
+
+  DataSources* m_dataSources = nullptr;
+  QString m_query;
+  QSet<const DataSourceItem*> m_matches;
+  QSet<const DataSourceItem*> m_ancestors;
+  QTimer m_refreshTimer;
+};
@@ -0,0 +1,115 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/Common/ThreadPool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+ThreadPool::ThreadPool(std::size_t threads, std::size_t group_limit)
+{
+  if(threads == 0)
+    threads = std::max(2U, std::thread::hardware_concurrency());
+  m_default_limit =
+      group_limit ? group_limit : std::max<std::size_t>(1, threads / 2);
+  m_workers.reserve(threads);
+  for(auto i = 0UL; i < threads; i++)
+    m_workers.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_closing = true;
+  }
+  m_cv.notify_all();
+  for(auto& worker : m_workers)
+  {
+    if(worker.joinable()) worker.join();
+  }
+}
+
+bool ThreadPool::submit(group_t group, job_t job)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if(m_closing) return false;
+    m_jobs.push_back({group, std::move(job)});
+  }
+  m_cv.notify_one();
+  return true;
+}
+
+void ThreadPool::setGroupLimit(group_t group, std::size_t limit)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_limits[group] = std::max<std::size_t>(1, limit);
+  }
+  m_cv.notify_all();
+}
+
+std::size_t ThreadPool::limit(group_t group) const
+{
+  if(auto it = m_limits.find(group); it != std::cend(m_limits))
+    return it->second;
+  return m_default_limit;
+}
+
+void ThreadPool::work()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  while(true)
+  {
+    auto next = std::end(m_jobs);
+    m_cv.wait(lock, [this, &next]() {
+      next = std::find_if(std::begin(m_jobs), std::end(m_jobs),
+                          [this](const auto& job) {
+                            return m_running[job.group] < limit(job.group);
+                          });
+      // queued jobs are still run on close, their owners may wait for them
+      return next != std::end(m_jobs) || (m_closing && std::empty(m_jobs));
+    });
+    if(next == std::end(m_jobs)) return;
+    auto [group, job] = std::move(*next);
+    m_jobs.erase(next);
+    m_running[group]++;
+    lock.unlock();
+    try
+    {
+      job();
+    }
+    catch(const std::exception& e)
+    {
+      std::cerr << "ThreadPool: job failed: " << e.what() << std::endl;
+    }
+    catch(...)
+    {
+      std::cerr << "ThreadPool: job failed" << std::endl;
+    }
+    lock.lock();
+    if(--m_running[group] == 0) m_running.erase(group);
+    // a slot of this group is free again, a job waiting for it may now run
+    m_cv.notify_all();
+  }
+}
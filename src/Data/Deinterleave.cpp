@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/Data/Deinterleave.hpp"
+
+#include <algorithm>
+
+#if(defined(__x86_64__) || defined(__i386__)) &&                               \
+    (defined(__GNUC__) || defined(__clang__))
+#define SCIQLOP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  using vector_kernel_t = void (*)(const double*, std::size_t, double*, double*,
+                                   double*);
+
+  // keeps the source and destination blocks in L1
+  constexpr std::size_t block_size = 512;
+
+  void transpose_blocked(const double* in, std::size_t size,
+                         std::size_t components, double* out)
+  {
+    for(auto block = 0UL; block < size; block += block_size)
+    {
+      const auto end = std::min(size, block + block_size);
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        double* dest = out + comp * size;
+        for(auto i = block; i < end; i++)
+          dest[i] = in[i * components + comp];
+      }
+    }
+  }
+
+  void vector_scalar(const double* in, std::size_t size, double* x, double* y,
+                     double* z)
+  {
+    for(auto i = 0UL; i < size; i++)
+    {
+      x[i] = in[3 * i];
+      y[i] = in[3 * i + 1];
+      z[i] = in[3 * i + 2];
+    }
+  }
+
+#ifdef SCIQLOP_X86_KERNELS
+  __attribute__((target("sse2"))) void
+  vector_sse2(const double* in, std::size_t size, double* x, double* y,
+              double* z)
+  {
+    auto i = 0UL;
+    // a = x0 y0, b = z0 x1, c = y1 z1
+    for(; i + 2 <= size; i += 2, in += 6)
+    {
+      const __m128d a = _mm_loadu_pd(in);
+      const __m128d b = _mm_loadu_pd(in + 2);
+      const __m128d c = _mm_loadu_pd(in + 4);
+      _mm_storeu_pd(x + i, _mm_shuffle_pd(a, b, 0b10));
+      _mm_storeu_pd(y + i, _mm_shuffle_pd(a, c, 0b01));
+      _mm_storeu_pd(z + i, _mm_shuffle_pd(b, c, 0b10));
+    }
+    vector_scalar(in, size - i, x + i, y + i, z + i);
+  }
+
+  __attribute__((target("avx"))) void vector_avx(const double* in,
+                                                 std::size_t size, double* x,
+                                                 double* y, double* z)
+  {
+    auto i = 0UL;
+    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+    for(; i + 4 <= size; i += 4, in += 12)
+    {
+      const __m256d a  = _mm256_loadu_pd(in);
+      const __m256d b  = _mm256_loadu_pd(in + 4);
+      const __m256d c  = _mm256_loadu_pd(in + 8);
+      const __m256d xy = _mm256_blend_pd(a, b, 0b1100); // x0 y0 x2 y2
+      const __m256d yz = _mm256_blend_pd(b, c, 0b1100); // y1 z1 y3 z3
+      const __m256d xz = _mm256_blend_pd(a, c, 0b0011); // z2 x3 z0 x1
+      const __m256d zx = _mm256_permute2f128_pd(xz, xz, 1); // z0 x1 z2 x3
+      _mm256_storeu_pd(x + i, _mm256_blend_pd(xy, zx, 0b1010));
+      _mm256_storeu_pd(y + i, _mm256_shuffle_pd(xy, yz, 0b0101));
+      _mm256_storeu_pd(z + i, _mm256_blend_pd(zx, yz, 0b1010));
+    }
+    vector_sse2(in, size - i, x + i, y + i, z + i);
+  }
+#endif
+
+  vector_kernel_t select_vector_kernel()
+  {
+#ifdef SCIQLOP_X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx")) return vector_avx;
+    if(__builtin_cpu_supports("sse2")) return vector_sse2;
+#endif
+    return vector_scalar;
+  }
+} // namespace
+
+void Deinterleave::deinterleave(const double* in, std::size_t size,
+                                std::size_t components, double* out)
+{
+  if(size == 0 || components == 0) return;
+  if(components == 1)
+  {
+    std::copy_n(in, size, out);
+  }
+  else if(components == 3)
+  {
+    static const auto kernel = select_vector_kernel();
+    kernel(in, size, out, out + size, out + 2 * size);
+  }
+  else
+  {
+    transpose_blocked(in, size, components, out);
+  }
+}
@@ -0,0 +1,175 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/Data/MappedTimeSerie.hpp"
+
+#include "SciQLopCore/Data/TimeSerieMerge.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cstring>
+
+/*
+ * File layout, native endianness:
+ *   header      see Header below
+ *   time axis   size doubles
+ *   channels    columns doubles, spectrograms only
+ *   values      size * columns doubles, row major
+ */
+namespace
+{
+  constexpr char magic[8]          = {'S', 'Q', 'L', 'P', 'T', 'S', 0, 0};
+  constexpr quint32 format_version = 1;
+
+  struct Header
+  {
+    char magic[8];
+    quint32 format;
+    quint32 type;
+    quint64 size;
+    quint64 columns;
+    double min_sampling;
+    double max_sampling;
+    quint32 y_is_log;
+    quint32 reserved;
+  };
+  static_assert(sizeof(Header) % sizeof(double) == 0,
+                "columns must stay aligned on doubles");
+
+  inline std::size_t channels(const TimeSerieLayout& layout) noexcept
+  {
+    return layout.type == DataSeriesType::SPECTROGRAM ? layout.columns : 0UL;
+  }
+
+  inline bool write_doubles(QIODevice& out, const double* data,
+                            std::size_t count)
+  {
+    const auto bytes = static_cast<qint64>(count * sizeof(double));
+    return out.write(reinterpret_cast<const char*>(data), bytes) == bytes;
+  }
+} // namespace
+
+MappedTimeSerie::MappedTimeSerie(const QString& file)
+    : m_file{std::make_unique<QFile>(file)}
+{
+  if(!m_file->open(QIODevice::ReadOnly)) return;
+  const auto file_size = m_file->size();
+  if(file_size < static_cast<qint64>(sizeof(Header))) return;
+  const auto data = m_file->map(0, file_size);
+  if(data == nullptr) return;
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  if(std::memcmp(header.magic, magic, sizeof(magic)) ||
+     header.format != format_version || header.columns == 0 ||
+     header.type == static_cast<quint32>(DataSeriesType::NONE) ||
+     header.type > static_cast<quint32>(DataSeriesType::SPECTROGRAM))
+    return;
+  m_layout.type    = static_cast<DataSeriesType>(header.type);
+  m_layout.columns = header.columns;
+  const auto doubles =
+      header.size * (1 + header.columns) + channels(m_layout);
+  if(static_cast<quint64>(file_size) !=
+     sizeof(Header) + sizeof(double) * doubles)
+    return;
+  // the header size keeps the columns aligned on doubles
+  m_size = header.size;
+  m_t    = reinterpret_cast<const double*>(data + sizeof(Header));
+  m_layout.y.assign(m_t + m_size, m_t + m_size + channels(m_layout));
+  m_values              = m_t + m_size + channels(m_layout);
+  m_layout.min_sampling = header.min_sampling;
+  m_layout.max_sampling = header.max_sampling;
+  m_layout.y_is_log     = header.y_is_log;
+  m_valid               = true;
+}
+
+MappedTimeSerie::MappedTimeSerie(MappedTimeSerie&&) noexcept = default;
+MappedTimeSerie&
+MappedTimeSerie::operator=(MappedTimeSerie&&) noexcept = default;
+MappedTimeSerie::~MappedTimeSerie() = default;
+
+TimeSeries::ITimeSerie*
+MappedTimeSerie::slice(double start, double stop) const
+{
+  if(!m_valid) return nullptr;
+  return TimeSeriesUtils::merge({view().slice(start, stop)}, m_layout);
+}
+
+bool MappedTimeSerie::write(const QString& file, TimeSeries::ITimeSerie* ts)
+{
+  return DataSeriesTypeUtils::visit(ts, [&file](auto* serie) {
+    const auto view = serie->view();
+    Writer writer{file, TimeSerieLayout::of(*serie)};
+    return writer.append(view.t, view.values, view.size) && writer.commit();
+  });
+}
+
+MappedTimeSerie::Writer::Writer(const QString& file,
+                                const TimeSerieLayout& layout)
+    : m_layout{layout}, m_file{file},
+      m_values{file + QStringLiteral(".values.XXXXXX")}
+{
+  // the header is only known on commit, its room is reserved first
+  const Header placeholder{};
+  m_ok = m_layout.type != DataSeriesType::NONE && m_layout.columns != 0 &&
+         channels(m_layout) == std::size(m_layout.y) &&
+         QDir{}.mkpath(QFileInfo{file}.path()) &&
+         m_file.open(QIODevice::WriteOnly) && m_values.open() &&
+         m_file.write(reinterpret_cast<const char*>(&placeholder),
+                      sizeof(placeholder)) == sizeof(placeholder);
+}
+
+bool MappedTimeSerie::Writer::append(const double* t, const double* values,
+                                     std::size_t count)
+{
+  m_ok = m_ok && write_doubles(m_file, t, count) &&
+         write_doubles(m_values, values, count * m_layout.columns);
+  m_size += count;
+  return m_ok;
+}
+
+bool MappedTimeSerie::Writer::commit()
+{
+  if(!m_ok) return false;
+  if(m_layout.type == DataSeriesType::SPECTROGRAM &&
+     !write_doubles(m_file, std::data(m_layout.y), std::size(m_layout.y)))
+    return false;
+  m_values.seek(0);
+  while(!m_values.atEnd())
+  {
+    const auto block = m_values.read(1 << 22);
+    if(block.isEmpty() || m_file.write(block) != block.size()) return false;
+  }
+  Header header{{},
+                format_version,
+                static_cast<quint32>(m_layout.type),
+                m_size,
+                m_layout.columns,
+                m_layout.min_sampling,
+                m_layout.max_sampling,
+                m_layout.y_is_log,
+                0};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  return m_file.seek(0) &&
+         m_file.write(reinterpret_cast<const char*>(&header),
+                      sizeof(header)) == sizeof(header) &&
+         m_file.commit();
+}
@@ -21,6 +21,12 @@
 ----------------------------------------------------------------------------*/
 #include "SciQLopCore/Data/Pipelines.hpp"
 
+#include "SciQLopCore/Common/ThreadPool.hpp"
+#include "SciQLopCore/Data/DataCache.hpp"
+#include "SciQLopCore/Data/DataConverters.hpp"
+#include "SciQLopCore/Data/Decimation.hpp"
+#include "SciQLopCore/Data/Regridding.hpp"
+#include "SciQLopCore/Data/TimePyramid.hpp"
 #include "SciQLopCore/DataSource/DataProviderParameters.hpp"
 #include "SciQLopCore/DataSource/DataSources.hpp"
 #include "SciQLopCore/DataSource/IDataProvider.hpp"
@@ -28,73 +34,19 @@
 #include "SciQLopCore/SciQLopCore.hpp"
 #include "SciQLopPlots/Qt/Graph.hpp"
 
-using data_t = std::pair<std::vector<double>, std::vector<double>>;
+#include <QLoggingCategory>
+#include <QResizeEvent>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
-data_t scalar_to_data_t(TimeSeries::ITimeSerie* ts)
-{
-  std::cout << "to_data_t" << std::endl;
-  auto scalar_ts = dynamic_cast<ScalarTimeSerie*>(ts);
-  std::cout << "size: " << scalar_ts->size() << std::endl;
-  std::vector<double> x(scalar_ts->size());
-  std::vector<double> y(scalar_ts->size());
-  for(auto i = 0UL; i < scalar_ts->size(); i++)
-  {
-    y[i] = scalar_ts->v(i);
-    x[i] = scalar_ts->t(i);
-  }
-  return {x, y};
-}
-
-data_t vector_to_data_t(TimeSeries::ITimeSerie* ts)
-{
-  if(ts)
-  {
-    auto vector_ts = dynamic_cast<VectorTimeSerie*>(ts);
-    const auto sz  = vector_ts->size();
-    std::vector<double> x(sz);
-    std::vector<double> y(3 * sz);
-    for(auto i = 0UL; i < sz; i++)
-    {
-      y[i]          = (*vector_ts)[i].x;
-      y[i + sz]     = (*vector_ts)[i].y;
-      y[i + 2 * sz] = (*vector_ts)[i].z;
-      x[i]          = vector_ts->t(i);
-    }
-    return {x, y};
-  }
-  return {};
-}
-
-data_t multicomponent_to_data_t(TimeSeries::ITimeSerie* ts)
-{
-  if(ts)
-  {
-    auto mc_ts          = dynamic_cast<MultiComponentTimeSerie*>(ts);
-    const auto sz       = mc_ts->size();
-    const auto comp_cnt = mc_ts->size(1);
-    std::vector<double> x(sz);
-    std::vector<double> y(comp_cnt * sz);
-    for(auto i = 0UL; i < sz; i++)
-    {
-      for(auto comp = 0UL; comp < comp_cnt; comp++)
-      {
-        y[i + (comp * sz)] = (*mc_ts)[i][comp];
-      }
-      x[i] = mc_ts->t(i);
-    }
+Q_LOGGING_CATEGORY(LOG_Pipelines, "Pipelines")
 
-    return {x, y};
-  }
-  return {};
-}
-
-template<DataSeriesType dst> data_t to_data_t(TimeSeries::ITimeSerie* ts)
-{
-  if constexpr(dst == DataSeriesType::SCALAR) return scalar_to_data_t(ts);
-  if constexpr(dst == DataSeriesType::VECTOR) return vector_to_data_t(ts);
-  if constexpr(dst == DataSeriesType::MULTICOMPONENT)
-    return multicomponent_to_data_t(ts);
-}
+using data_t = DataConverters::data_t;
 
 template<DataSeriesType ds_type>
 inline int components_count(const QVariantHash& metaData)
@@ -107,82 +59,343 @@ inline int components_count(const QVariantHash& metaData)
   if constexpr(ds_type == DataSeriesType::SPECTROGRAM) return 1;
 }
 
+template<typename data_t, DataSeriesType ds_type>
+inline auto make_graph(SciQLopPlots::SciQLopPlot* plot,
+                       const QVariantHash& metaData)
+{
+  if constexpr(ds_type == DataSeriesType::SPECTROGRAM)
+    return SciQLopPlots::add_colormap<data_t>(plot);
+  else
+    return SciQLopPlots::add_graph<data_t>(plot,
+                                           components_count<ds_type>(metaData));
+}
+
 template<typename data_t, DataSeriesType ds_type>
 class Pipeline : public IPipeline
 {
   using graph_indexes_t = std::vector<int>;
-  std::thread genThread;
-  SciQLopPlots::Graph<data_t, SciQLopPlots::SciQLopPlot> graph;
-  IDataProvider* provider;
-
-  std::vector<QColor> colors = {Qt::blue, Qt::red, Qt::green, Qt::yellow};
+  using graph_t =
+      decltype(make_graph<data_t, ds_type>(nullptr, QVariantHash{}));
+  graph_t graph;
 
-public:
-  Pipeline(SciQLopPlots::SciQLopPlot* plot, IDataProvider* provider,
-           QVariantHash metaData, QColor color = Qt::blue)
-      : IPipeline{plot}, graph{SciQLopPlots::add_graph<data_t>(
-                             plot, components_count<ds_type>(metaData))},
-        provider{provider}
+  // everything the fetch jobs touch, each job holds a reference so the
+  // pipeline can be destroyed without waiting for it (a Python provider may
+  // need the GIL the destroying thread holds to return)
+  struct state_t : std::enable_shared_from_this<state_t>
   {
-    std::cout << "Pipeline ctor" << std::endl;
-    genThread = std::thread([&graph = graph, &in = graph.transformations_out,
-                             metaData, provider]() {
-      while(!in.closed())
+    state_t(Pipelines& pipelines, const ProductHandle& product,
+            graph_t* graph, std::size_t width, std::size_t height)
+        : provider{product.provider}, metaData{*product.metaData},
+          productId{product.id}, pipelines{pipelines},
+          cache{static_cast<std::size_t>(
+              components_count<ds_type>(*product.metaData))},
+          pyramid{static_cast<std::size_t>(
+              components_count<ds_type>(*product.metaData))},
+          plotWidth{width}, plotHeight{height}, graph{graph}
+    {}
+
+    IDataProvider* provider;
+    QVariantHash metaData;
+    // concurrent fetches of the same product are shared, see
+    // Pipelines::getData
+    quint64 productId;
+    Pipelines& pipelines;
+    DataCache cache;
+    // aggregates serving zoomed out views, unused for spectrograms
+    TimePyramid pyramid;
+    // graph is decimated to ~4 points per pixel column of the plot
+    std::atomic<std::size_t> plotWidth;
+    // spectrograms are regridded to one cell per pixel
+    std::atomic<std::size_t> plotHeight;
+    // last spectrogram channels seen, only touched from generate()
+    struct
+    {
+      std::vector<double> y;
+      bool log            = true;
+      double max_sampling = std::nan("");
+      // time dependent channels were reported once
+      bool rejected = false;
+    } channels;
+
+    // only the most recent range is kept, older ones are stale before they
+    // start
+    std::mutex requestMutex;
+    std::optional<DateTimeRange> pendingRange;
+    CancellationToken currentRequest;
+    // at most one job per pipeline is queued or running on the executor
+    bool jobScheduled = false;
+    bool closing      = false;
+
+    // reset by ~Pipeline, jobs still running then drop their results
+    std::mutex graphMutex;
+    graph_t* graph;
+
+    bool schedule()
+    {
+      return pipelines.executor().submit(
+          provider, [self = this->shared_from_this()]() { self->generate(); });
+    }
+
+    // called on the GUI thread each time the plot range changes
+    void requestRange(const DateTimeRange& range)
+    {
+      CancellationToken superseded;
       {
-        if(auto maybeNewRange = in.take(); maybeNewRange)
+        std::lock_guard<std::mutex> lock{requestMutex};
+        pendingRange = range;
+        superseded   = currentRequest;
+        if(!jobScheduled && !closing) jobScheduled = schedule();
+      }
+      // cancel hooks may block (the Python ones take the GIL), never call
+      // them with requestMutex held
+      superseded.cancel();
+    }
+
+    // stops scheduling jobs and cancels the running one without waiting
+    void close()
+    {
+      CancellationToken superseded;
+      {
+        std::lock_guard<std::mutex> lock{requestMutex};
+        closing    = true;
+        superseded = currentRequest;
+      }
+      {
+        std::lock_guard<std::mutex> lock{graphMutex};
+        graph = nullptr;
+      }
+      superseded.cancel();
+    }
+
+    std::optional<std::pair<DateTimeRange, CancellationToken>> nextRequest()
+    {
+      std::lock_guard<std::mutex> lock{requestMutex};
+      if(closing || !pendingRange) return std::nullopt;
+      auto range = *pendingRange;
+      pendingRange.reset();
+      currentRequest = CancellationToken{};
+      return std::make_pair(range, currentRequest);
+    }
+
+    // ends the job, unless a range arrived since the last nextRequest()
+    void jobDone()
+    {
+      std::lock_guard<std::mutex> lock{requestMutex};
+      if(pendingRange && !closing && schedule()) return;
+      jobScheduled = false;
+    }
+
+    template<typename T> void publish(T&& data)
+    {
+      std::lock_guard<std::mutex> lock{graphMutex};
+      if(graph) *graph << std::forward<T>(data);
+    }
+
+    void generate()
+    {
+      // jobScheduled must be reset on every exit, provider errors included
+      struct job_guard_t
+      {
+        state_t* self;
+        ~job_guard_t() { self->jobDone(); }
+      } guard{this};
+      while(auto request = nextRequest())
+      {
+        const auto& [range, token] = *request;
+        auto fetch = [this, &token = token](const DateTimeRange& r)
+            -> std::optional<DataCache::data_t> {
+          DataProviderParameters p{r, metaData, token};
+          auto ts = pipelines.getData(productId, provider, p);
+          if(token.cancelled()) return std::nullopt;
+          // failures and series of another kind aren't cached, the range is
+          // fetched again next time
+          const auto serie = dynamic_cast<TimeSerieOf<ds_type>*>(ts.get());
+          if(!serie) return std::nullopt;
+          if constexpr(ds_type == DataSeriesType::SPECTROGRAM)
+          {
+            if(serie->size())
+            {
+              const auto& y = serie->y_axis();
+              // one set of channels per sample can't be regridded, the range
+              // is cached as empty so it isn't fetched again
+              if(std::size(y) != serie->size(1))
+              {
+                if(!std::exchange(channels.rejected, true))
+                  qCWarning(LOG_Pipelines)
+                      << "Spectrograms with time dependent channels aren't "
+                         "supported,"
+                      << std::size(y) << "channel values for"
+                      << serie->size(1) << "channels";
+                return DataCache::data_t{};
+              }
+              channels.y            = {std::cbegin(y), std::cend(y)};
+              channels.log          = serie->y_is_log;
+              channels.max_sampling = serie->max_sampling;
+            }
+          }
+          // providers may return more than asked, only r reaches the cache
+          return DataConverters::view_to_data_t(
+              serie->slice(r.m_TStart, r.m_TEnd));
+        };
+        if constexpr(ds_type != DataSeriesType::SPECTROGRAM)
         {
-          std::cout << "Update" << std::endl;
-          DataProviderParameters p{
-              {maybeNewRange->first, maybeNewRange->second}, metaData};
-          graph << to_data_t<ds_type>(provider->getData(p));
+          if(auto tiles = pyramid.get(range, plotWidth))
+          {
+            publish(std::move(*tiles));
+            continue;
+          }
+        }
+        if(auto data = cache.get(range, fetch); data && !token.cancelled())
+        {
+          if constexpr(ds_type == DataSeriesType::SPECTROGRAM)
+            publish(Regridding::regrid(*data, channels.y, range, plotWidth,
+                                       plotHeight, channels.log,
+                                       channels.max_sampling));
+          else
+          {
+            pyramid.insert(*data, range);
+            publish(Decimation::m4(std::move(*data), range, plotWidth));
+          }
         }
       }
-    });
-    graph.transformations_out.add(plot->xRange());
-  }
-  inline ~Pipeline() override
+    }
+  };
+  std::shared_ptr<state_t> state;
+
+  std::vector<QColor> colors = {Qt::blue, Qt::red, Qt::green, Qt::yellow};
+
+public:
+  Pipeline(Pipelines& pipelines, SciQLopPlots::SciQLopPlot* plot,
+           const ProductHandle& product, QColor color = Qt::blue)
+      : IPipeline{plot},
+        graph{make_graph<data_t, ds_type>(plot, *product.metaData)},
+        state{std::make_shared<state_t>(
+            pipelines, product, &graph, static_cast<std::size_t>(plot->width()),
+            static_cast<std::size_t>(plot->height()))}
   {
+    plot->installEventFilter(this);
+    // ranges are taken from the plot signal, nothing reads the graph channel
     graph.transformations_out.close();
-    if(genThread.joinable()) genThread.join();
-    std::cout << "Pipeline::~Pipeline()" << std::endl;
+    connect(plot, &SciQLopPlots::SciQLopPlot::xRangeChanged, this,
+            [this](const SciQLopPlots::axis::range& range) {
+              state->requestRange({range.first, range.second});
+            });
+    const auto range = plot->xRange();
+    state->requestRange({range.first, range.second});
   }
+  inline ~Pipeline() override { state->close(); }
+
+  bool eventFilter(QObject* watched, QEvent* event) override
+  {
+    if(event->type() == QEvent::Resize)
+    {
+      const auto size   = static_cast<QResizeEvent*>(event)->size();
+      state->plotWidth  = static_cast<std::size_t>(size.width());
+      state->plotHeight = static_cast<std::size_t>(size.height());
+    }
+    return IPipeline::eventFilter(watched, event);
+  }
+};
+
+struct Pipelines::InFlightRequest
+{
+  InFlightRequest(quint64 productId, const DataProviderParameters& parameters,
+                  std::shared_future<std::shared_ptr<TimeSeries::ITimeSerie>>
+                      result)
+      : productId{productId},
+        parameters{parameters.m_Range, parameters.m_Data},
+        result{std::move(result)}
+  {}
+  quint64 productId;
+  // carries its own token, cancelled when no requester is left
+  DataProviderParameters parameters;
+  std::shared_future<std::shared_ptr<TimeSeries::ITimeSerie>> result;
+  std::atomic<int> requesters{0};
 };
 
 void Pipelines::addPipeline(IPipeline* p) { m_pipelines.push_back(p); }
 
+std::shared_ptr<TimeSeries::ITimeSerie>
+Pipelines::getData(quint64 productId, IDataProvider* provider,
+                   const DataProviderParameters& parameters)
+{
+  std::promise<std::shared_ptr<TimeSeries::ITimeSerie>> promise;
+  std::shared_ptr<InFlightRequest> request;
+  bool owner = false;
+  {
+    std::lock_guard<std::mutex> lock{m_inFlightMutex};
+    if(auto it = std::find_if(std::cbegin(m_inFlight), std::cend(m_inFlight),
+                              [&](const auto& r) {
+                                // a fetch every requester left is aborting
+                                return !r->parameters.m_Cancellation
+                                            .cancelled() &&
+                                       r->productId == productId &&
+                                       r->parameters.m_Range ==
+                                           parameters.m_Range;
+                              });
+       it != std::cend(m_inFlight))
+    {
+      request = *it;
+    }
+    else
+    {
+      request = std::make_shared<InFlightRequest>(
+          productId, parameters, promise.get_future().share());
+      m_inFlight.push_back(request);
+      owner = true;
+    }
+    request->requesters++;
+  }
+  // the requester token may outlive the request by far, its hook doesn't
+  // keep the request (and its result) alive and is dropped once served
+  struct hook_t
+  {
+    const CancellationToken& token;
+    std::size_t id;
+    ~hook_t() { token.removeOnCancel(id); }
+  } hook{parameters.m_Cancellation,
+         parameters.m_Cancellation.onCancel(
+             [weak = std::weak_ptr<InFlightRequest>{request}]() {
+               if(auto request = weak.lock();
+                  request && --request->requesters == 0)
+                 request->parameters.m_Cancellation.cancel();
+             })};
+  if(owner)
+  {
+    try
+    {
+      promise.set_value(std::shared_ptr<TimeSeries::ITimeSerie>{
+          provider->cacheable()
+              ? m_sampleCache.getData(provider, request->parameters)
+              : provider->getData(request->parameters)});
+    }
+    catch(...)
+    {
+      promise.set_exception(std::current_exception());
+    }
+    std::lock_guard<std::mutex> lock{m_inFlightMutex};
+    m_inFlight.erase(
+        std::find(std::cbegin(m_inFlight), std::cend(m_inFlight), request));
+  }
+  return request->result.get();
+}
+
 Pipelines::Pipelines(QObject* parent) : QObject{parent} {}
 
 void Pipelines::plot(const QStringList& products,
                      SciQLopPlots::SciQLopPlot* plot)
 {
-  for(const auto& product : products)
+  for(const auto& path : products)
   {
-    auto provider = SciQLopCore::dataSources().provider(product);
-    auto ds_type  = SciQLopCore::dataSources().dataSeriesType(product);
-    auto metaData = SciQLopCore::dataSources().nodeData(product);
-    switch(ds_type)
-    {
-      case DataSeriesType::SCALAR: {
-        std::cout << "Scalar TS" << std::endl;
-        addPipeline(new Pipeline<data_t, DataSeriesType::SCALAR>(plot, provider,
-                                                                 metaData));
-      }
-      break;
-      case DataSeriesType::VECTOR: {
-        std::cout << "Vector TS" << std::endl;
-        addPipeline(new Pipeline<data_t, DataSeriesType::VECTOR>(plot, provider,
-                                                                 metaData));
-      }
-      break;
-
-      case DataSeriesType::MULTICOMPONENT: {
-        std::cout << "Vector MULTICOMPONENT" << std::endl;
-        addPipeline(new Pipeline<data_t, DataSeriesType::MULTICOMPONENT>(
-            plot, provider, metaData));
-      }
-      break;
-      default: break;
-    }
-    std::cout << provider << std::endl;
+    const auto product = SciQLopCore::dataSources().resolve(path);
+    if(!product.isValid()) continue;
+    DataSeriesTypeUtils::visit_type(product.dataSeriesType, [&](auto tag) {
+      constexpr auto ds_type =
+          data_series_type_v<typename decltype(tag)::type>;
+      using graph_data_t =
+          std::conditional_t<ds_type == DataSeriesType::SPECTROGRAM,
+                             Regridding::grid_t, data_t>;
+      addPipeline(new Pipeline<graph_data_t, ds_type>(*this, plot, product));
+    });
   }
 }
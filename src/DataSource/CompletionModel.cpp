@@ -0,0 +1,141 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/DataSource/CompletionModel.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+  // above this many insertion points one layout change is cheaper than
+  // shifting the storage once per run
+  constexpr std::size_t max_insert_runs = 64;
+
+  inline bool less(const QString& a, const QString& b)
+  {
+    const auto cmp = QString::compare(a, b, Qt::CaseInsensitive);
+    return cmp < 0 || (cmp == 0 && a < b);
+  }
+} // namespace
+
+CompletionModel::CompletionModel(QObject* parent) : QAbstractListModel{parent}
+{}
+
+int CompletionModel::rowCount(const QModelIndex& parent) const
+{
+  if(parent.isValid()) return 0;
+  return static_cast<int>(std::size(m_strings));
+}
+
+QVariant CompletionModel::data(const QModelIndex& index, int role) const
+{
+  if(!index.isValid() || index.row() >= rowCount()) return QVariant{};
+  if(role == Qt::DisplayRole || role == Qt::EditRole)
+    return m_strings[static_cast<std::size_t>(index.row())];
+  return QVariant{};
+}
+
+void CompletionModel::insert(const QSet<QString>& strings)
+{
+  std::vector<QString> batch;
+  batch.reserve(static_cast<std::size_t>(strings.size()));
+  std::copy_if(std::cbegin(strings), std::cend(strings),
+               std::back_inserter(batch), [this](const auto& s) {
+                 return !s.isEmpty() &&
+                        !std::binary_search(std::cbegin(m_strings),
+                                            std::cend(m_strings), s, less);
+               });
+  if(std::empty(batch)) return;
+  std::sort(std::begin(batch), std::end(batch), less);
+
+  // insertion points in the current list, one per run of new strings
+  std::vector<std::pair<std::size_t, std::size_t>> runs; // position, count
+  for(const auto& s : batch)
+  {
+    const auto pos = static_cast<std::size_t>(std::distance(
+        std::cbegin(m_strings), std::lower_bound(std::cbegin(m_strings),
+                                                 std::cend(m_strings), s,
+                                                 less)));
+    if(!std::empty(runs) && runs.back().first == pos)
+      runs.back().second++;
+    else
+      runs.emplace_back(pos, 1);
+  }
+
+  if(std::size(runs) > max_insert_runs)
+  {
+    emit layoutAboutToBeChanged();
+    const auto old_rows = persistentIndexList();
+    std::vector<QString> merged;
+    merged.reserve(std::size(m_strings) + std::size(batch));
+    std::merge(std::make_move_iterator(std::begin(m_strings)),
+               std::make_move_iterator(std::end(m_strings)),
+               std::make_move_iterator(std::begin(batch)),
+               std::make_move_iterator(std::end(batch)),
+               std::back_inserter(merged), less);
+    std::vector<QString> previous = std::move(m_strings);
+    m_strings                     = std::move(merged);
+    QModelIndexList new_rows;
+    for(const auto& index : old_rows)
+    {
+      const auto& s   = previous[static_cast<std::size_t>(index.row())];
+      const auto row = std::distance(
+          std::cbegin(m_strings),
+          std::lower_bound(std::cbegin(m_strings), std::cend(m_strings), s,
+                           less));
+      new_rows << this->index(static_cast<int>(row));
+    }
+    changePersistentIndexList(old_rows, new_rows);
+    emit layoutChanged();
+    return;
+  }
+
+  auto next    = std::make_move_iterator(std::begin(batch));
+  auto shifted = std::size_t{0};
+  for(const auto& [pos, count] : runs)
+  {
+    const auto first = static_cast<int>(pos + shifted);
+    beginInsertRows(QModelIndex{}, first, first + static_cast<int>(count) - 1);
+    m_strings.insert(std::begin(m_strings) + first, next,
+                     next + static_cast<std::ptrdiff_t>(count));
+    endInsertRows();
+    next += static_cast<std::ptrdiff_t>(count);
+    shifted += count;
+  }
+}
+
+std::pair<int, int> CompletionModel::prefixRange(const QString& prefix) const
+{
+  auto starts_before = [](const QString& s, const QString& p) {
+    return QString::compare(s.left(p.size()), p, Qt::CaseInsensitive) < 0;
+  };
+  auto prefix_before = [](const QString& p, const QString& s) {
+    return QString::compare(p, s.left(p.size()), Qt::CaseInsensitive) < 0;
+  };
+  const auto first = std::lower_bound(std::cbegin(m_strings),
+                                      std::cend(m_strings), prefix,
+                                      starts_before);
+  const auto last =
+      std::upper_bound(first, std::cend(m_strings), prefix, prefix_before);
+  return {static_cast<int>(std::distance(std::cbegin(m_strings), first)),
+          static_cast<int>(std::distance(std::cbegin(m_strings), last))};
+}
@@ -24,38 +24,305 @@
 #include "SciQLopCore/DataSource/DataSourceItemAction.hpp"
 #include "SciQLopCore/DataSource/DataSourceItemMergeHelper.hpp"
 
+#include <QHash>
+#include <QSet>
 #include <QUuid>
 #include <QVector>
+#include <array>
+#include <atomic>
 #include <containers/algorithms.hpp>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <optional>
+#include <utility>
 
 const QString DataSourceItem::NAME_DATA_KEY   = QStringLiteral("name");
 const QString DataSourceItem::PLUGIN_DATA_KEY = QStringLiteral("plugin");
 const QString DataSourceItem::ID_DATA_KEY     = QStringLiteral("uuid");
 
+namespace
+{
+  /**
+   * @brief Strings shared by the metadata of every item.
+   *
+   * Keys and most values ("plugin", "type", units, provider ids...) repeat
+   * across the whole inventory, items only store their ids and interned
+   * QStrings share their buffer. Entries are reference counted through
+   * PooledString, strings of removed products leave the pool with them and
+   * their ids get reused.
+   *
+   * Only interning and reference counting take the mutex. An entry never
+   * moves and its string doesn't change while it is referenced, so holders of
+   * an id read it without locking.
+   */
+  class StringPool
+  {
+    struct entry_t
+    {
+      QString str;
+      quint32 refs = 0;
+    };
+    // segment k holds first_segment << k entries, 25 of them cover every id
+    static constexpr quint32 first_segment = 256;
+    std::mutex m_mutex;
+    QHash<QString, quint32> m_ids;
+    std::array<std::atomic<entry_t*>, 25> m_segments{};
+    quint32 m_size = 0;
+    std::vector<quint32> m_free;
+
+    /// segment of @p id and its position in it
+    static inline std::pair<std::size_t, quint64> locate(quint32 id) noexcept
+    {
+      const auto n    = static_cast<quint64>(id) / first_segment + 1;
+      std::size_t seg = 0;
+      while(n >> (seg + 1))
+        seg++;
+      return {seg, id - first_segment * ((quint64{1} << seg) - 1)};
+    }
+
+    inline entry_t& entry(quint32 id) const noexcept
+    {
+      const auto [seg, pos] = locate(id);
+      return m_segments[seg].load(std::memory_order_acquire)[pos];
+    }
+
+    // called with the mutex held
+    quint32 allocate()
+    {
+      if(!std::empty(m_free))
+      {
+        const auto id = m_free.back();
+        m_free.pop_back();
+        return id;
+      }
+      const auto id = m_size++;
+      if(const auto [seg, pos] = locate(id); pos == 0)
+        m_segments[seg].store(new entry_t[quint64{first_segment} << seg],
+                              std::memory_order_release);
+      return id;
+    }
+
+  public:
+    /// Adds a reference to @p str, interning it if needed
+    quint32 intern(const QString& str)
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if(auto it = m_ids.constFind(str); it != m_ids.cend())
+      {
+        entry(*it).refs++;
+        return *it;
+      }
+      const auto id = allocate();
+      auto& e       = entry(id);
+      e             = {str, 1};
+      m_ids.insert(e.str, id);
+      return id;
+    }
+
+    void retain(quint32 id)
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      entry(id).refs++;
+    }
+
+    void release(quint32 id)
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      auto& e = entry(id);
+      if(--e.refs == 0)
+      {
+        m_ids.remove(e.str);
+        e.str = QString{};
+        m_free.push_back(id);
+      }
+    }
+
+    /// String of a referenced id, no lock taken
+    inline const QString& at(quint32 id) const noexcept
+    {
+      return entry(id).str;
+    }
+  };
+
+  StringPool& string_pool()
+  {
+    // never destroyed, items of static objects may outlive it otherwise
+    static auto pool = new StringPool;
+    return *pool;
+  }
+
+  /// Reference to a pool entry, the string stays interned while referenced
+  class PooledString
+  {
+    static constexpr quint32 none = std::numeric_limits<quint32>::max();
+    quint32 m_id = none;
+
+  public:
+    PooledString() = default;
+    explicit PooledString(const QString& str)
+        : m_id{string_pool().intern(str)}
+    {}
+    PooledString(const PooledString& other) : m_id{other.m_id}
+    {
+      if(m_id != none) string_pool().retain(m_id);
+    }
+    PooledString(PooledString&& other) noexcept
+        : m_id{std::exchange(other.m_id, none)}
+    {}
+    PooledString& operator=(PooledString other) noexcept
+    {
+      std::swap(m_id, other.m_id);
+      return *this;
+    }
+    ~PooledString()
+    {
+      if(m_id != none) string_pool().release(m_id);
+    }
+
+    inline quint32 id() const noexcept { return m_id; }
+    inline QString str() const
+    {
+      return m_id == none ? QString{} : string_pool().at(m_id);
+    }
+    inline bool operator==(const QString& other) const
+    {
+      return m_id != none && string_pool().at(m_id) == other;
+    }
+    inline bool operator==(const PooledString& other) const noexcept
+    {
+      return m_id == other.m_id;
+    }
+  };
+
+  // the returned QString shares its buffer with the equal strings held by
+  // other items, which keep the pool entry alive
+  inline QString interned(const QString& str)
+  {
+    return PooledString{str}.str();
+  }
+
+  /**
+   * @brief Item metadata stored as (key id, value id) pairs sorted by key.
+   *
+   * Only string values are interned, anything else (lists built by
+   * DataSourceItem::setData with append) goes to a regular hash which stays
+   * empty for most items.
+   */
+  class CompactData
+  {
+    std::vector<std::pair<PooledString, PooledString>> m_strings;
+    QVariantHash m_others;
+
+    auto lower_bound(quint32 key) const
+    {
+      return std::lower_bound(
+          std::cbegin(m_strings), std::cend(m_strings), key,
+          [](const auto& entry, quint32 k) { return entry.first.id() < k; });
+    }
+
+  public:
+    CompactData() = default;
+    explicit CompactData(const QVariantHash& data)
+    {
+      for(auto it = data.cbegin(); it != data.cend(); ++it)
+        insert(it.key(), it.value());
+    }
+
+    void insert(const QString& key, const QVariant& value)
+    {
+      PooledString key_ref{key};
+      auto it = m_strings.begin() + std::distance(std::cbegin(m_strings),
+                                                  lower_bound(key_ref.id()));
+      const bool found = it != m_strings.end() && it->first == key_ref;
+      if(value.userType() == QMetaType::QString)
+      {
+        PooledString value_ref{value.toString()};
+        if(found)
+          it->second = std::move(value_ref);
+        else
+          m_strings.insert(it, {std::move(key_ref), std::move(value_ref)});
+        m_others.remove(key);
+      }
+      else
+      {
+        if(found) m_strings.erase(it);
+        m_others.insert(key, value);
+      }
+    }
+
+    QVariant value(const QString& key) const
+    {
+      // a handful of keys per item, compared without locking the pool
+      for(const auto& [k, v] : m_strings)
+        if(k == key) return v.str();
+      return m_others.value(key);
+    }
+
+    QVariantHash toHash() const
+    {
+      QVariantHash result = m_others;
+      for(const auto& [key, value] : m_strings)
+        result.insert(key.str(), value.str());
+      return result;
+    }
+
+    bool containsText(const QString& text) const
+    {
+      for(const auto& entry : m_strings)
+        if(string_pool().at(entry.second.id()).contains(text,
+                                                        Qt::CaseInsensitive))
+          return true;
+      for(const auto& value : m_others)
+        if(value.toString().contains(text, Qt::CaseInsensitive)) return true;
+      return false;
+    }
+
+    bool operator==(const CompactData& other) const
+    {
+      return m_strings == other.m_strings && m_others == other.m_others;
+    }
+  };
+} // namespace
+
 struct DataSourceItem::DataSourceItemPrivate
 {
   explicit DataSourceItemPrivate(DataSourceItemType type, const QString& name,
                                  DataSeriesType ds_type, QVariantHash data,
                                  QString sourceUUID)
-      : m_Parent{nullptr}, m_dataSourceUid{sourceUUID},
-        m_Children{}, m_name{name}, m_ds_type{ds_type}, m_Type{type},
-        m_Data{std::move(data)}, m_Actions{}
+      : m_Parent{nullptr}, m_Id{++s_lastId},
+        m_dataSourceUid{sourceUUID}, m_Children{},
+        m_ds_type{ds_type}, m_name{interned(name)}, m_Type{type},
+        m_Data{data}, m_Actions{}
   {
-    m_Data[DataSourceItem::NAME_DATA_KEY] = name;
+    m_Data.insert(DataSourceItem::NAME_DATA_KEY, m_name);
   }
   ~DataSourceItemPrivate();
+  static inline std::atomic<quint64> s_lastId{0};
   DataSourceItem* m_Parent;
-  QString m_dataSourceUid;
+  quint64 m_Id;
+  // position in the parent children, kept up to date by the parent
+  int m_Index = 0;
+  PooledString m_dataSourceUid;
   std::vector<std::unique_ptr<DataSourceItem>> m_Children;
-  QString m_icon;
-  QString m_name;
+  struct children_index_t
+  {
+    // first child with a given name, folders can hold thousands of children
+    QHash<QString, DataSourceItem*> first;
+    // children beyond the first one for the names shared by several children
+    QHash<QString, int> homonyms;
+  };
+  // only allocated while the item has children, most items are products
+  std::unique_ptr<children_index_t> m_ChildrenIndex;
+  PooledString m_icon;
   DataSeriesType m_ds_type;
+  QString m_name;
   DataSourceItemType m_Type;
+  bool m_Lazy = false;
 
-  // TODO check if QVariant is really wise here, looks quite overkill
-  // maybe a simple map<string,string> could be enough
-  QVariantHash m_Data;
+  CompactData m_Data;
+  // only set on tree roots, see DataSourceItem::setDataChangedCallback
+  std::unique_ptr<std::function<void(const DataSourceItem*)>> m_DataChanged;
   std::vector<std::unique_ptr<DataSourceItemAction>> m_Actions;
   auto begin() noexcept { return m_Children.begin(); }
   auto end() noexcept { return m_Children.end(); }
@@ -63,20 +330,26 @@ struct DataSourceItem::DataSourceItemPrivate
   auto cend() const noexcept { return m_Children.cend(); }
   inline QString source_uuid() const noexcept
   {
-    return m_dataSourceUid;
+    return m_dataSourceUid.str();
   }
-  int index_of(const DataSourceItem* item)
+  void index_name(DataSourceItem* child)
   {
-    return std::distance(std::cbegin(m_Children),
-                         std::find_if(std::cbegin(m_Children),
-                                      std::cend(m_Children),
-                                      [item](const auto& other) {
-                                        return other.get() == item;
-                                      }));
+    if(!m_ChildrenIndex) m_ChildrenIndex = std::make_unique<children_index_t>();
+    auto& [first, homonyms] = *m_ChildrenIndex;
+    if(auto it = first.find(child->name()); it == first.end())
+      first.insert(child->name(), child);
+    else
+    {
+      homonyms[child->name()]++;
+      if(child->impl->m_Index < (*it)->impl->m_Index) *it = child;
+    }
   }
   inline QString name() const noexcept { return m_name; }
-  inline QString icon() const noexcept { return m_icon; }
-  inline void setIcon(const QString& iconName) { m_icon = iconName; }
+  inline QString icon() const noexcept { return m_icon.str(); }
+  inline void setIcon(const QString& iconName)
+  {
+    m_icon = PooledString{iconName};
+  }
   inline DataSeriesType dataSeriesType() { return m_ds_type; }
 };
 
@@ -97,7 +370,7 @@ DataSourceItem::~DataSourceItem() = default;
 std::unique_ptr<DataSourceItem> DataSourceItem::clone() const
 {
   auto result = std::make_unique<DataSourceItem>(
-      impl->m_Type, impl->m_name, impl->dataSeriesType(), impl->m_Data,impl->source_uuid()+"_copy");
+      impl->m_Type, impl->m_name, impl->dataSeriesType(), impl->m_Data.toHash(),impl->source_uuid()+"_copy");
 
   // Clones children
   for(const auto& child : impl->m_Children)
@@ -135,18 +408,53 @@ void DataSourceItem::addAction(
 void DataSourceItem::appendChild(std::unique_ptr<DataSourceItem> child) noexcept
 {
   child->impl->m_Parent = this;
+  child->impl->m_Index  = childCount();
+  impl->index_name(child.get());
   impl->m_Children.push_back(std::move(child));
 }
 
 void DataSourceItem::removeChild(DataSourceItem* child) noexcept
 {
-  if(auto node =
-         std::find_if(std::begin(impl->m_Children), std::end(impl->m_Children),
-                      [child](const auto& n) { return n.get() == child; });
-     node != std::cend(impl->m_Children))
+  if(child && child->parentItem() == this)
+    removeChildren(child->impl->m_Index, 1);
+}
+
+void DataSourceItem::removeChildren(int first, int count) noexcept
+{
+  if(first < 0 || count <= 0 || first + count > childCount()) return;
+  auto& children   = impl->m_Children;
+  auto& names      = *impl->m_ChildrenIndex;
+  const auto begin = std::begin(children) + first;
+  const auto end   = begin + count;
+  // names whose first child is removed while a homonym remains
+  QSet<QString> orphans;
+  for(auto it = begin; it != end; ++it)
+  {
+    const auto name          = (*it)->name();
+    const bool first_of_name = names.first.value(name) == it->get();
+    if(first_of_name) names.first.remove(name);
+    if(auto homonyms = names.homonyms.find(name);
+       homonyms != names.homonyms.end())
+    {
+      if(--*homonyms == 0) names.homonyms.erase(homonyms);
+      if(first_of_name) orphans.insert(name);
+    }
+    else // the last child with this name
+      orphans.remove(name);
+  }
+  children.erase(begin, end);
+  if(std::empty(children))
+  {
+    impl->m_ChildrenIndex.reset();
+    return;
+  }
+  for(auto index = first; index < childCount(); index++)
+    children[index]->impl->m_Index = index;
+  // the first remaining homonym of each removed name takes its place
+  for(auto it = std::cbegin(children);
+      !orphans.isEmpty() && it != std::cend(children); ++it)
   {
-    std::swap(*node, impl->m_Children.back());
-    impl->m_Children.resize(std::size(impl->m_Children) - 1);
+    if(orphans.remove((*it)->name())) impl->index_name(it->get());
   }
 }
 
@@ -166,7 +474,17 @@ QVariant DataSourceItem::data(const QString& key) const noexcept
   return impl->m_Data.value(key);
 }
 
-QVariantHash DataSourceItem::data() const noexcept { return impl->m_Data; }
+QVariantHash DataSourceItem::data() const noexcept
+{
+  return impl->m_Data.toHash();
+}
+
+std::shared_ptr<const QVariantHash> DataSourceItem::sharedData() const noexcept
+{
+  return std::make_shared<const QVariantHash>(impl->m_Data.toHash());
+}
+
+quint64 DataSourceItem::id() const noexcept { return impl->m_Id; }
 
 void DataSourceItem::merge(const DataSourceItem& item)
 {
@@ -206,6 +524,10 @@ QString DataSourceItem::path() const noexcept
   return path;
 }
 
+bool DataSourceItem::isLazy() const noexcept { return impl->m_Lazy; }
+
+void DataSourceItem::setLazy(bool lazy) noexcept { impl->m_Lazy = lazy; }
+
 DataSeriesType DataSourceItem::dataSeriesType() const noexcept
 {
   return impl->dataSeriesType();
@@ -218,10 +540,7 @@ DataSourceItem* DataSourceItem::parentItem() const noexcept
 
 int DataSourceItem::index() const noexcept
 {
-  if(auto parent = parentItem(); parent)
-  {
-    return parent->impl->index_of(this);
-  }
+  if(parentItem()) return impl->m_Index;
   return 0;
 }
 
@@ -233,18 +552,18 @@ const DataSourceItem& DataSourceItem::rootItem() const noexcept
 void DataSourceItem::setData(const QString& key, const QVariant& value,
                              bool append) noexcept
 {
-  auto it = impl->m_Data.constFind(key);
-  if(append && it != impl->m_Data.constEnd())
+  auto previous = impl->m_Data.value(key);
+  if(append && previous.isValid())
   {
     // Case of an existing value to which we want to add to the new value
-    if(it->canConvert<QVariantList>())
+    if(previous.canConvert<QVariantList>())
     {
-      auto variantList = it->value<QVariantList>();
+      auto variantList = previous.value<QVariantList>();
       variantList.append(value);
 
       impl->m_Data.insert(key, variantList);
     }
-    else { impl->m_Data.insert(key, QVariantList{*it, value}); }
+    else { impl->m_Data.insert(key, QVariantList{previous, value}); }
   }
   else
   {
@@ -253,6 +572,32 @@ void DataSourceItem::setData(const QString& key, const QVariant& value,
     // - replacement of an existing value (not appending)
     impl->m_Data.insert(key, value);
   }
+  if(const auto& callback = rootItem().impl->m_DataChanged) (*callback)(this);
+}
+
+void DataSourceItem::setProduct(DataSeriesType ds_type,
+                                const QVariantHash& data,
+                                const QString& sourceUUID) noexcept
+{
+  impl->m_ds_type       = ds_type;
+  impl->m_dataSourceUid = PooledString{sourceUUID};
+  impl->m_Data          = CompactData{data};
+  impl->m_Data.insert(NAME_DATA_KEY, impl->m_name);
+  if(const auto& callback = rootItem().impl->m_DataChanged) (*callback)(this);
+}
+
+void DataSourceItem::setDataChangedCallback(
+    std::function<void(const DataSourceItem*)> callback) noexcept
+{
+  impl->m_DataChanged =
+      callback ? std::make_unique<std::function<void(const DataSourceItem*)>>(
+                     std::move(callback))
+               : nullptr;
+}
+
+bool DataSourceItem::containsText(const QString& text) const noexcept
+{
+  return impl->m_Data.containsText(text);
 }
 
 DataSourceItemType DataSourceItem::type() const noexcept
@@ -265,7 +610,7 @@ DataSourceItem* DataSourceItem::findItem(const QVariantHash& data,
 {
   for(const auto& child : impl->m_Children)
   {
-    if(child->impl->m_Data == data) { return child.get(); }
+    if(child->impl->m_Data.toHash() == data) { return child.get(); }
 
     if(recursive)
     {
@@ -278,11 +623,8 @@ DataSourceItem* DataSourceItem::findItem(const QVariantHash& data,
 
 DataSourceItem* DataSourceItem::findItem(const QString& name)
 {
-  auto item =
-      std::find_if(std::cbegin(impl->m_Children), std::cend(impl->m_Children),
-                   [name](const auto& item) { return item->name() == name; });
-  if(item != std::cend(impl->m_Children)) return item->get();
-  return nullptr;
+  return impl->m_ChildrenIndex ? impl->m_ChildrenIndex->first.value(name)
+                              : nullptr;
 }
 
 DataSourceItem* DataSourceItem::findItem(const QString& datasourceIdKey,
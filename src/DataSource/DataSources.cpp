@@ -29,6 +29,8 @@
 #include "containers/algorithms.hpp"
 
 #include <QDataStream>
+#include <algorithm>
+#include <functional>
 #include <iostream>
 
 QString QVariant2QString(const QVariant& variant) noexcept
@@ -54,6 +56,17 @@ inline std::unique_ptr<DataSourceItem> make_folder_item(const QString& name)
       DataSourceItemType::NODE, name, DataSeriesType::NONE, QVariantHash{}, "");
 }
 
+// path as providers give it ("/a/b"), DataSourceItem::path() also starts
+// with the root item empty name
+inline QString provider_path(const DataSourceItem* item)
+{
+  QStringList names;
+  for(auto node = item; node->parentItem() != nullptr;
+      node      = node->parentItem())
+    names.prepend(node->name());
+  return '/' + names.join('/');
+}
+
 template<typename T>
 DataSourceItem* walk_tree(
     const T& path_list_begin, const T& path_list_end, DataSourceItem* root,
@@ -128,12 +141,163 @@ make_product_item(const QString& name, DataSeriesType ds_type,
   return result;
 }
 
+/**
+ * @brief Stages new items so they reach the model with one beginInsertRows()
+ * per already displayed parent.
+ *
+ * New items whose parent is already in the tree are kept aside, grouped by
+ * parent. Deeper new items are appended directly to those detached subtrees,
+ * which views can't see yet.
+ */
+class DataSources::PendingItems
+{
+  struct Group
+  {
+    DataSourceItem* parent;
+    std::vector<std::unique_ptr<DataSourceItem>> children;
+    QHash<QString, DataSourceItem*> byName;
+  };
+  DataSourceItem* m_root;
+  std::vector<Group> m_groups;
+  QHash<DataSourceItem*, std::size_t> m_groupOf;
+  QSet<DataSourceItem*> m_detached;
+  // products of the tree registered again, with their previous provider
+  std::vector<std::pair<DataSourceItem*, QString>> m_updated;
+
+  Group& group(DataSourceItem* parent)
+  {
+    if(auto it = m_groupOf.constFind(parent); it != m_groupOf.cend())
+      return m_groups[*it];
+    m_groupOf[parent] = std::size(m_groups);
+    m_groups.push_back({parent, {}, {}});
+    return m_groups.back();
+  }
+
+  DataSourceItem* find(DataSourceItem* parent, const QString& name)
+  {
+    if(auto item = parent->findItem(name)) return item;
+    if(auto it = m_groupOf.constFind(parent); it != m_groupOf.cend())
+      return m_groups[*it].byName.value(name, nullptr);
+    return nullptr;
+  }
+
+  DataSourceItem* append(DataSourceItem* parent,
+                         std::unique_ptr<DataSourceItem> item)
+  {
+    auto ptr = item.get();
+    m_detached.insert(ptr);
+    if(m_detached.contains(parent))
+      parent->appendChild(std::move(item));
+    else
+    {
+      auto& g = group(parent);
+      g.byName[ptr->name()] = ptr;
+      g.children.push_back(std::move(item));
+    }
+    return ptr;
+  }
+
+public:
+  explicit PendingItems(DataSourceItem* root) : m_root{root} {}
+
+  DataSourceItem* addProduct(const QString& providerUid, const QString& path,
+                             DataSeriesType ds_type,
+                             const QMap<QString, QString>& metaData,
+                             QSet<QString>& completion_data)
+  {
+    auto path_list = path.split('/', Qt::SkipEmptyParts);
+    if(path_list.isEmpty()) return nullptr;
+    auto name   = path_list.takeLast();
+    auto parent = m_root;
+    for(const auto& folder_name : path_list)
+    {
+      auto folder = find(parent, folder_name);
+      parent = folder ? folder : append(parent, make_folder_item(folder_name));
+    }
+    QVariantHash meta_data{{DataSourceItem::NAME_DATA_KEY, name}};
+    completion_data << name;
+    for(auto it = metaData.cbegin(); it != metaData.cend(); ++it)
+    {
+      meta_data[it.key()] = it.value();
+      completion_data << it.key();
+    }
+    // registered again (loaded inventory, previous batch or another
+    // provider), the latest registration wins
+    if(auto item = find(parent, name);
+       item && item->type() == DataSourceItemType::PRODUCT)
+    {
+      meta_data[DataSourceItem::PLUGIN_DATA_KEY] = QStringLiteral("test");
+      if(item->source_uuid() != providerUid ||
+         item->dataSeriesType() != ds_type || item->data() != meta_data)
+      {
+        if(!m_detached.contains(item))
+          m_updated.emplace_back(item, item->source_uuid());
+        item->setProduct(ds_type, meta_data, providerUid);
+      }
+      return item;
+    }
+    return append(parent, make_product_item(name, ds_type, meta_data,
+                                            providerUid, "test", nullptr));
+  }
+
+  DataSourceItem* addFolder(const QString& providerUid, const QString& path,
+                            bool lazy)
+  {
+    auto path_list = path.split('/', Qt::SkipEmptyParts);
+    if(path_list.isEmpty()) return nullptr;
+    auto name   = path_list.takeLast();
+    auto parent = m_root;
+    for(const auto& folder_name : path_list)
+    {
+      auto folder = find(parent, folder_name);
+      parent = folder ? folder : append(parent, make_folder_item(folder_name));
+    }
+    // an existing folder is already populated (or shared with other providers)
+    if(find(parent, name)) return nullptr;
+    // unlike intermediate folders, these know their provider which can fetch
+    // their content later
+    auto folder = std::make_unique<DataSourceItem>(
+        DataSourceItemType::NODE, name, DataSeriesType::NONE, QVariantHash{},
+        providerUid);
+    folder->setLazy(lazy);
+    return append(parent, std::move(folder));
+  }
+
+  /**
+   * @brief Moves staged items into the tree, @p notify is called once per
+   * parent with the number of new children and the function to call between
+   * beginInsertRows() and endInsertRows(), @p updated once per product of
+   * the tree registered again with its previous provider
+   */
+  template<typename notify_t, typename updated_t>
+  void insert(notify_t&& notify, updated_t&& updated)
+  {
+    for(auto& g : m_groups)
+    {
+      notify(g.parent, static_cast<int>(std::size(g.children)), [&g]() {
+        for(auto& child : g.children)
+          g.parent->appendChild(std::move(child));
+      });
+    }
+    for(const auto& [item, previous_provider] : m_updated)
+      updated(item, previous_provider);
+    m_groups.clear();
+    m_groupOf.clear();
+    m_detached.clear();
+    m_updated.clear();
+  }
+};
+
 DataSources::DataSources()
     : SciQLopObject{this},
       _root(new DataSourceItem(DataSourceItemType::NODE, "",
                                DataSeriesType::NONE, QVariantHash{}, "")),
-      _completionModel(new QStringListModel)
-{}
+      _completionModel(new CompletionModel)
+{
+  // searches check the items metadata, edited items get their trigrams again
+  _root->setDataChangedCallback(
+      [this](const DataSourceItem* item) { _index.update(item); });
+}
 
 DataSources::~DataSources()
 {
@@ -236,80 +400,264 @@ Qt::ItemFlags DataSources::flags(const QModelIndex& index) const
   return flags;
 }
 
-// TODO This can be optimized to only use insert row and column
-// this should be much faster than doing a ResetModel all the time
-// but this is more difficult to implement
 void DataSources::addDataSourceItem(
     const QString& providerUid, const QString& path, DataSeriesType ds_type,
     const QMap<QString, QString>& metaData) noexcept
 {
-  beginResetModel();
   QSet<QString> completion_data;
-  auto path_list = path.split('/', Qt::SkipEmptyParts);
-  auto name      = *(std::cend(path_list) - 1);
-  auto path_item =
-      make_path_items(std::cbegin(path_list), std::cend(path_list) - 1, _root);
-  completion_data << name;
-  QVariantHash meta_data{{DataSourceItem::NAME_DATA_KEY, name}};
-  std::for_each(metaData.keyBegin(), metaData.keyEnd(),
-                [&](const auto& key) { meta_data[key] = metaData[key];completion_data << key; });
-  path_item->appendChild(
-      make_product_item(name, ds_type, meta_data, providerUid, "test", this));
-  endResetModel();
-  _updateCompletionModel(completion_data);
-  _Products[providerUid].append(path);
+  PendingItems pending{_root};
+  if(auto item = pending.addProduct(providerUid, path, ds_type, metaData,
+                                    completion_data))
+    _ProviderItems[providerUid].insert(item);
+  _insertPendingItems(pending);
+  _completionModel->insert(completion_data);
 }
 
 void DataSources::addProducts(const QString& providerUid,
                               const QVector<Product*>& products)
 {
-  beginResetModel();
   QSet<QString> completion_data;
+  PendingItems pending{_root};
+  auto& provider_items = _ProviderItems[providerUid];
   for(const auto product : products)
   {
-    auto path_list = product->path.split('/', Qt::SkipEmptyParts);
-    auto name      = *(std::cend(path_list) - 1);
-    auto path_item = make_path_items(std::cbegin(path_list),
-                                     std::cend(path_list) - 1, _root);
-    QVariantHash meta_data{{DataSourceItem::NAME_DATA_KEY, name}};
-    completion_data << name;
-    std::for_each(
-        product->metadata.keyBegin(), product->metadata.keyEnd(),
-        [&](const auto& key) {
-        meta_data[key] = product->metadata[key];
-        completion_data << key;
-    });
-    path_item->appendChild(make_product_item(name, product->ds_type, meta_data,
-                                             providerUid, "test", this));
-    _Products[providerUid].append(product->path);
+    if(auto item = pending.addProduct(providerUid, product->path,
+                                      product->ds_type, product->metadata,
+                                      completion_data))
+      provider_items.insert(item);
+  }
+  _insertPendingItems(pending);
+  _completionModel->insert(completion_data);
+}
+
+void DataSources::addLazyFolders(const QString& providerUid,
+                                 const QStringList& paths)
+{
+  PendingItems pending{_root};
+  auto& provider_items = _ProviderItems[providerUid];
+  for(const auto& path : paths)
+  {
+    if(auto item = pending.addFolder(providerUid, path, true))
+      provider_items.insert(item);
+  }
+  _insertPendingItems(pending);
+}
+
+bool DataSources::loadInventory(const QString& providerUid,
+                                const QString& version)
+{
+  using Kind = InventoryCache::EntryKind;
+  QSet<QString> completion_data;
+  PendingItems pending{_root};
+  std::vector<DataSourceItem*> items;
+  const auto loaded = _inventoryCache.load(
+      providerUid, version, [&](const InventoryCache::Entry& entry) {
+        auto item = entry.kind == Kind::Product
+                        ? pending.addProduct(providerUid, entry.path,
+                                             entry.dataSeriesType,
+                                             entry.metaData, completion_data)
+                        : pending.addFolder(providerUid, entry.path,
+                                            entry.kind == Kind::LazyFolder);
+        if(item) items.push_back(item);
+      });
+  // nothing reached the tree yet, a stale snapshot is simply dropped
+  if(!loaded) return false;
+  auto& provider_items = _ProviderItems[providerUid];
+  for(auto item : items)
+    provider_items.insert(item);
+  _insertPendingItems(pending);
+  _completionModel->insert(completion_data);
+  return true;
+}
+
+QStringList DataSources::products(const QString& providerUid) const
+{
+  QStringList paths;
+  if(auto provider_items = _ProviderItems.find(providerUid);
+     provider_items != std::cend(_ProviderItems))
+  {
+    for(const auto item : provider_items->second)
+      if(item->type() == DataSourceItemType::PRODUCT)
+        paths << provider_path(item);
+  }
+  return paths;
+}
+
+bool DataSources::saveInventory(const QString& providerUid,
+                                const QString& version) const
+{
+  using Kind = InventoryCache::EntryKind;
+  auto provider_items = _ProviderItems.find(providerUid);
+  if(provider_items == std::cend(_ProviderItems)) return false;
+  // ids follow registration order, parents come before their content
+  std::vector<const DataSourceItem*> items{
+      std::cbegin(provider_items->second), std::cend(provider_items->second)};
+  std::sort(std::begin(items), std::end(items),
+            [](auto a, auto b) { return a->id() < b->id(); });
+  std::vector<InventoryCache::Entry> entries(std::size(items));
+  std::transform(
+      std::cbegin(items), std::cend(items), std::begin(entries),
+      [](const DataSourceItem* item) {
+        InventoryCache::Entry entry;
+        entry.path = provider_path(item);
+        if(item->type() == DataSourceItemType::NODE)
+        {
+          entry.kind = item->isLazy() ? Kind::LazyFolder : Kind::Folder;
+          return entry;
+        }
+        entry.dataSeriesType = item->dataSeriesType();
+        auto data            = item->data();
+        data.remove(DataSourceItem::NAME_DATA_KEY);
+        data.remove(DataSourceItem::PLUGIN_DATA_KEY);
+        for(auto it = data.cbegin(); it != data.cend(); ++it)
+          entry.metaData.insert(it.key(), it.value().toString());
+        return entry;
+      });
+  return _inventoryCache.save(providerUid, version, entries);
+}
+
+bool DataSources::hasChildren(const QModelIndex& parent) const
+{
+  if(parent.isValid())
+  {
+    auto item = static_cast<DataSourceItem*>(parent.internalPointer());
+    if(item->isLazy()) return true;
   }
-  _updateCompletionModel(completion_data);
-  endResetModel();
+  return QAbstractItemModel::hasChildren(parent);
+}
+
+bool DataSources::canFetchMore(const QModelIndex& parent) const
+{
+  if(!parent.isValid()) return false;
+  return static_cast<DataSourceItem*>(parent.internalPointer())->isLazy();
+}
+
+void DataSources::fetchMore(const QModelIndex& parent)
+{
+  if(!parent.isValid()) return;
+  auto item = static_cast<DataSourceItem*>(parent.internalPointer());
+  if(!item->isLazy()) return;
+  // cleared first, the provider registers children from this call
+  item->setLazy(false);
+  if(auto provider = _DataProviders.find(item->source_uuid());
+     provider != std::cend(_DataProviders))
+    provider->second->fetchProducts(provider_path(item));
+}
+
+void DataSources::_insertPendingItems(PendingItems& pending)
+{
+  pending.insert(
+      [this](DataSourceItem* parent, int count, const auto& apply) {
+        const auto parent_index = parent == _root
+                                      ? QModelIndex{}
+                                      : createIndex(parent->index(), 0, parent);
+        const auto first = parent->childCount();
+        beginInsertRows(parent_index, first, first + count - 1);
+        apply();
+        for(auto row = first; row < parent->childCount(); row++)
+          _index.add(parent->child(row));
+        endInsertRows();
+      },
+      [this](DataSourceItem* item, const QString& previous_provider) {
+        // the provider registering it last owns it now
+        if(previous_provider != item->source_uuid())
+        {
+          if(auto it = _ProviderItems.find(previous_provider);
+             it != std::end(_ProviderItems))
+            it->second.remove(item);
+        }
+        const auto index = createIndex(item->index(), 0, item);
+        emit dataChanged(index, index);
+      });
 }
 
 void DataSources::removeDataSourceItems(const QStringList& paths) noexcept
 {
-  beginResetModel();
+  std::vector<DataSourceItem*> items;
+  items.reserve(std::size(paths));
   for(const auto& path : paths)
   {
-    auto node = walk_tree(path, _root);
-    if(node != nullptr) { node->parentItem()->removeChild(node); }
+    if(auto node = walk_tree(path, _root); node != nullptr)
+      items.push_back(node);
+  }
+  _removeItems(items);
+}
+
+void DataSources::_removeItems(const std::vector<DataSourceItem*>& items)
+{
+  QSet<DataSourceItem*> removed{std::cbegin(items), std::cend(items)};
+  auto ancestor_removed = [&removed](DataSourceItem* item) {
+    for(auto parent = item->parentItem(); parent; parent = parent->parentItem())
+      if(removed.contains(parent)) return true;
+    return false;
+  };
+  // items to remove grouped by parent, nested items go with their ancestor
+  std::map<DataSourceItem*, std::vector<DataSourceItem*>> pending;
+  for(auto item : removed)
+  {
+    if(item != _root && item->parentItem() && !ancestor_removed(item))
+      pending[item->parentItem()].push_back(item);
   }
-  endResetModel();
+  while(!pending.empty())
+  {
+    std::map<DataSourceItem*, std::vector<DataSourceItem*>> emptied;
+    for(const auto& [parent, children] : pending)
+    {
+      const auto parent_index = parent == _root
+                                    ? QModelIndex{}
+                                    : createIndex(parent->index(), 0, parent);
+      std::vector<int> rows(std::size(children));
+      std::transform(std::cbegin(children), std::cend(children),
+                     std::begin(rows), [](auto item) { return item->index(); });
+      // one beginRemoveRows per contiguous run, last run first so the
+      // remaining rows stay valid
+      std::sort(std::begin(rows), std::end(rows), std::greater<int>{});
+      for(auto it = std::cbegin(rows); it != std::cend(rows);)
+      {
+        auto last  = *it;
+        auto first = *it;
+        while(++it != std::cend(rows) && *it == first - 1)
+          first = *it;
+        beginRemoveRows(parent_index, first, last);
+        for(auto row = first; row <= last; row++)
+        {
+          _index.remove(parent->child(row));
+          _untrack(parent->child(row));
+        }
+        parent->removeChildren(first, last - first + 1);
+        endRemoveRows();
+      }
+      // don't leave empty folders behind, they belong to no provider
+      if(parent != _root && parent->childCount() == 0 &&
+         parent->source_uuid().isEmpty())
+        emptied[parent->parentItem()].push_back(parent);
+    }
+    pending = std::move(emptied);
+  }
+}
+
+void DataSources::_untrack(DataSourceItem* item)
+{
+  if(auto it = _ProviderItems.find(item->source_uuid());
+     it != std::end(_ProviderItems))
+    it->second.remove(item);
+  for(const auto& child : *item)
+    _untrack(child.get());
 }
 
 void DataSources::addProvider(IDataProvider* provider) noexcept
 {
   _DataProviders.insert({provider->name(), provider});
-  _Products[provider->name()] = QStringList{};
+  _ProviderItems[provider->name()] = {};
 }
 
 void DataSources::removeProvider(IDataProvider* provider) noexcept
 {
-  assert(cpp_utils::containers::contains(_Products, provider->name()));
-  removeDataSourceItems(_Products[provider->name()]);
+  assert(cpp_utils::containers::contains(_ProviderItems, provider->name()));
+  const auto& items = _ProviderItems[provider->name()];
+  _removeItems({std::cbegin(items), std::cend(items)});
   _DataProviders.erase(provider->name());
-  _Products.erase(provider->name());
+  _ProviderItems.erase(provider->name());
 }
 
 void DataSources::setIcon(const QString& path, const QString& iconName)
@@ -318,9 +666,8 @@ void DataSources::setIcon(const QString& path, const QString& iconName)
   if(node != nullptr) { node->setIcon(iconName); }
 }
 
-IDataProvider* DataSources::provider(const QString& path)
+IDataProvider* DataSources::_provider(const DataSourceItem* node) const
 {
-  auto node = walk_tree(path, _root);
   if(node != nullptr)
   {
     if(auto ds_uuid = node->source_uuid();
@@ -334,6 +681,27 @@ IDataProvider* DataSources::provider(const QString& path)
   return nullptr;
 }
 
+IDataProvider* DataSources::provider(const QString& path)
+{
+  return _provider(walk_tree(path, _root));
+}
+
+QSet<const DataSourceItem*>
+DataSources::search(const QString& query) const
+{
+  return _index.search(query);
+}
+
+ProductHandle DataSources::resolve(const QString& path)
+{
+  auto node = walk_tree(path, _root);
+  if(auto provider = _provider(node))
+  {
+    return {provider, node->dataSeriesType(), node->sharedData(), node->id()};
+  }
+  return {};
+}
+
 DataSeriesType DataSources::dataSeriesType(const QString& path)
 {
   auto node = walk_tree(path, _root);
@@ -347,14 +715,3 @@ QVariantHash DataSources::nodeData(const QString& path)
   if(node != nullptr) { return node->data(); }
   return {};
 }
-
-void DataSources::_updateCompletionModel(const QSet<QString> new_data)
-{
-  auto currentList = _completionModel->stringList();
-  std::for_each(new_data.cbegin(), new_data.cend(),
-                [&currentList](const auto& value) {
-                  currentList << value;
-                });
-  currentList.removeDuplicates();
-  _completionModel->setStringList(currentList);
-}
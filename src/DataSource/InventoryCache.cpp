@@ -0,0 +1,238 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/DataSource/InventoryCache.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+#include <vector>
+
+/*
+ * File layout, native endianness (snapshots aren't meant to be shared between
+ * machines):
+ *   header      magic, format version, string count, entry count
+ *   strings     string count times (byte count: quint32, UTF-8 bytes), the
+ *               provider name and version token come first
+ *   entries     entry count times (kind: quint8, series type: quint8,
+ *               path id: quint32, metadata count: quint32,
+ *               metadata count times (key id: quint32, value id: quint32))
+ */
+namespace
+{
+  constexpr char magic[8]             = {'S', 'Q', 'L', 'P', 'I', 'N', 'V', 0};
+  constexpr quint32 format_version    = 1;
+  constexpr quint32 endianness_marker = 0x01020304;
+
+  struct Header
+  {
+    char magic[8];
+    quint32 endianness;
+    quint32 format;
+    quint32 strings;
+    quint32 entries;
+  };
+
+  class Reader
+  {
+    const uchar* m_it;
+    const uchar* m_end;
+
+  public:
+    Reader(const uchar* data, qint64 size) : m_it{data}, m_end{data + size} {}
+
+    template<typename T> bool read(T& value)
+    {
+      if(m_end - m_it < static_cast<std::ptrdiff_t>(sizeof(T))) return false;
+      std::memcpy(&value, m_it, sizeof(T));
+      m_it += sizeof(T);
+      return true;
+    }
+
+    bool read(QString& value)
+    {
+      quint32 size;
+      if(!read(size) || m_end - m_it < static_cast<std::ptrdiff_t>(size))
+        return false;
+      value = QString::fromUtf8(reinterpret_cast<const char*>(m_it),
+                                static_cast<int>(size));
+      m_it += size;
+      return true;
+    }
+
+    bool atEnd() const noexcept { return m_it == m_end; }
+  };
+
+  class Writer
+  {
+    QByteArray m_strings;
+    QByteArray m_entries;
+    QHash<QString, quint32> m_ids;
+    quint32 m_count = 0;
+
+    template<typename T> static void append(QByteArray& buffer, T value)
+    {
+      buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+  public:
+    /// Appends @p value to the string table, even if already there
+    quint32 string(const QString& value)
+    {
+      const auto utf8 = value.toUtf8();
+      append(m_strings, static_cast<quint32>(utf8.size()));
+      m_strings.append(utf8);
+      return m_count++;
+    }
+
+    quint32 id(const QString& value)
+    {
+      if(auto it = m_ids.constFind(value); it != m_ids.cend()) return *it;
+      return m_ids[value] = string(value);
+    }
+
+    void add(const InventoryCache::Entry& entry)
+    {
+      append(m_entries, static_cast<quint8>(entry.kind));
+      append(m_entries, static_cast<quint8>(entry.dataSeriesType));
+      append(m_entries, id(entry.path));
+      append(m_entries, static_cast<quint32>(entry.metaData.size()));
+      for(auto it = entry.metaData.cbegin(); it != entry.metaData.cend(); ++it)
+      {
+        append(m_entries, id(it.key()));
+        append(m_entries, id(it.value()));
+      }
+    }
+
+    QByteArray header(quint32 entries) const
+    {
+      Header header{{}, endianness_marker, format_version, m_count, entries};
+      std::memcpy(header.magic, magic, sizeof(magic));
+      return QByteArray(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    const QByteArray& strings() const noexcept { return m_strings; }
+    const QByteArray& entries() const noexcept { return m_entries; }
+  };
+} // namespace
+
+InventoryCache::InventoryCache(const QString& directory)
+    : m_directory{directory}
+{}
+
+QString InventoryCache::defaultDirectory()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         QStringLiteral("/inventories");
+}
+
+QString InventoryCache::fileName(const QString& provider) const
+{
+  // provider names aren't necessarily valid file names
+  const auto key =
+      QCryptographicHash::hash(provider.toUtf8(), QCryptographicHash::Sha1)
+          .toHex();
+  return m_directory + '/' + QString::fromLatin1(key) +
+         QStringLiteral(".inventory");
+}
+
+bool InventoryCache::load(const QString& provider, const QString& version,
+                          const std::function<void(const Entry&)>& visit) const
+{
+  QFile file{fileName(provider)};
+  if(!file.open(QIODevice::ReadOnly)) return false;
+  const auto size = file.size();
+  const auto data = file.map(0, size);
+  if(data == nullptr) return false;
+  Reader reader{data, size};
+
+  Header header;
+  if(!reader.read(header) || std::memcmp(header.magic, magic, sizeof(magic)) ||
+     header.endianness != endianness_marker ||
+     header.format != format_version || header.strings < 2)
+    return false;
+
+  // each string takes at least its byte count, a corrupt count must not
+  // allocate past what the file can hold
+  if(header.strings > static_cast<quint64>(size) / sizeof(quint32))
+    return false;
+  std::vector<QString> strings;
+  strings.reserve(header.strings);
+  for(auto index = 0U; index < header.strings; index++)
+  {
+    QString string;
+    if(!reader.read(string)) return false;
+    strings.push_back(std::move(string));
+  }
+  if(strings[0] != provider || strings[1] != version) return false;
+
+  Entry entry;
+  for(auto index = 0U; index < header.entries; index++)
+  {
+    quint8 kind, ds_type;
+    quint32 path, count;
+    if(!reader.read(kind) || !reader.read(ds_type) || !reader.read(path) ||
+       !reader.read(count) || kind > static_cast<quint8>(EntryKind::LazyFolder) ||
+       ds_type > static_cast<quint8>(DataSeriesType::SPECTROGRAM) ||
+       path >= header.strings)
+      return false;
+    entry.kind           = static_cast<EntryKind>(kind);
+    entry.dataSeriesType = static_cast<DataSeriesType>(ds_type);
+    entry.path           = strings[path];
+    entry.metaData.clear();
+    for(auto pair = 0U; pair < count; pair++)
+    {
+      quint32 key, value;
+      if(!reader.read(key) || !reader.read(value) || key >= header.strings ||
+         value >= header.strings)
+        return false;
+      entry.metaData.insert(strings[key], strings[value]);
+    }
+    visit(entry);
+  }
+  return reader.atEnd();
+}
+
+bool InventoryCache::save(const QString& provider, const QString& version,
+                          const std::vector<Entry>& entries) const
+{
+  if(!QDir{}.mkpath(m_directory)) return false;
+  Writer writer;
+  writer.string(provider);
+  writer.string(version);
+  for(const auto& entry : entries)
+    writer.add(entry);
+  QSaveFile file{fileName(provider)};
+  if(!file.open(QIODevice::WriteOnly)) return false;
+  file.write(writer.header(static_cast<quint32>(std::size(entries))));
+  file.write(writer.strings());
+  file.write(writer.entries());
+  return file.commit();
+}
+
+bool InventoryCache::remove(const QString& provider) const
+{
+  return QFile::remove(fileName(provider));
+}
@@ -0,0 +1,170 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/DataSource/ProductsIndex.hpp"
+
+#include "SciQLopCore/DataSource/DataSourceItem.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+  constexpr auto trigram_size = 3;
+  // below this count holes are cheaper than a rebuild
+  constexpr std::size_t min_compaction = 1024;
+
+  std::vector<quint64> trigrams(const QString& text)
+  {
+    std::vector<quint64> result;
+    if(text.size() < trigram_size) return result;
+    result.reserve(static_cast<std::size_t>(text.size()));
+    for(auto i = 0; i + trigram_size <= text.size(); i++)
+    {
+      result.push_back((quint64{text[i].unicode()} << 32) |
+                       (quint64{text[i + 1].unicode()} << 16) |
+                       quint64{text[i + 2].unicode()});
+    }
+    std::sort(std::begin(result), std::end(result));
+    result.erase(std::unique(std::begin(result), std::end(result)),
+                 std::end(result));
+    return result;
+  }
+
+  // fields are separated so trigrams never span two of them
+  QString search_text(const DataSourceItem* item)
+  {
+    QString text = item->name();
+    const auto data = item->data();
+    for(auto it = data.cbegin(); it != data.cend(); ++it)
+    {
+      if(it.key() != DataSourceItem::NAME_DATA_KEY)
+      {
+        text.append('\n');
+        text.append(it.value().toString());
+      }
+    }
+    return text.toLower();
+  }
+} // namespace
+
+void ProductsIndex::add(const DataSourceItem* item)
+{
+  if(item == nullptr) return;
+  index(item);
+  for(const auto& child : *item)
+    add(child.get());
+}
+
+void ProductsIndex::remove(const DataSourceItem* item)
+{
+  unindex(item);
+  if(m_removed > min_compaction && m_removed > size()) compact();
+}
+
+void ProductsIndex::update(const DataSourceItem* item)
+{
+  if(!release(item)) return;
+  index(item);
+  if(m_removed > min_compaction && m_removed > size()) compact();
+}
+
+QSet<const DataSourceItem*> ProductsIndex::search(const QString& query) const
+{
+  QSet<const DataSourceItem*> result;
+  const auto q = query.toLower();
+  if(q.isEmpty()) return result;
+  auto matches = [&](quint32 slot) {
+    if(m_items[slot] && m_items[slot]->containsText(query))
+      result.insert(m_items[slot]);
+  };
+  if(q.size() < trigram_size)
+  {
+    for(auto slot = 0U; slot < std::size(m_items); slot++)
+      matches(slot);
+    return result;
+  }
+  std::vector<const std::vector<quint32>*> lists;
+  for(const auto trigram : trigrams(q))
+  {
+    auto it = m_postings.constFind(trigram);
+    if(it == m_postings.cend()) return result;
+    lists.push_back(&(*it));
+  }
+  std::sort(std::begin(lists), std::end(lists),
+            [](auto a, auto b) { return std::size(*a) < std::size(*b); });
+  std::vector<quint32> candidates = *lists.front();
+  std::vector<quint32> intersection;
+  for(auto list = std::next(std::cbegin(lists));
+      list != std::cend(lists) && !std::empty(candidates); ++list)
+  {
+    intersection.clear();
+    std::set_intersection(std::cbegin(candidates), std::cend(candidates),
+                          std::cbegin(**list), std::cend(**list),
+                          std::back_inserter(intersection));
+    std::swap(candidates, intersection);
+  }
+  for(const auto slot : candidates)
+    matches(slot);
+  return result;
+}
+
+void ProductsIndex::index(const DataSourceItem* item)
+{
+  if(m_slots.contains(item)) return;
+  const auto slot = static_cast<quint32>(std::size(m_items));
+  m_items.push_back(item);
+  m_slots.insert(item, slot);
+  for(const auto trigram : trigrams(search_text(item)))
+    m_postings[trigram].push_back(slot);
+}
+
+bool ProductsIndex::release(const DataSourceItem* item)
+{
+  if(auto it = m_slots.find(item); it != m_slots.end())
+  {
+    m_items[*it] = nullptr;
+    m_slots.erase(it);
+    m_removed++;
+    return true;
+  }
+  return false;
+}
+
+void ProductsIndex::unindex(const DataSourceItem* item)
+{
+  if(item == nullptr) return;
+  release(item);
+  for(const auto& child : *item)
+    unindex(child.get());
+}
+
+void ProductsIndex::compact()
+{
+  // trigrams are computed again, cheaper than keeping every text around
+  auto items = std::move(m_items);
+  m_items.clear();
+  m_slots.clear();
+  m_postings.clear();
+  m_removed = 0;
+  for(const auto item : items)
+    if(item != nullptr) index(item);
+}
@@ -0,0 +1,330 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/DataSource/SampleCache.hpp"
+
+#include "SciQLopCore/Data/MappedTimeSerie.hpp"
+#include "SciQLopCore/Data/TimeSerieMerge.hpp"
+#include "SciQLopCore/DataSource/IDataProvider.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+
+/*
+ * Chunks are MappedTimeSerie files holding the samples of one bucket.
+ */
+namespace
+{
+  // wider requests aren't worth splitting into buckets
+  constexpr qint64 max_buckets = 4096;
+
+  enum class ReadStatus
+  {
+    Ok,
+    // missing or corrupt chunk file
+    Invalid,
+    // valid chunk whose shape differs from the chunks already read
+    Incompatible
+  };
+
+  inline bool compatible(const TimeSerieLayout& dst,
+                         const TimeSerieLayout& layout) noexcept
+  {
+    return dst.type == DataSeriesType::NONE || dst.sameShape(layout);
+  }
+
+  bool write(const QString& file, const TimeSerieLayout& layout,
+             const TimeSerieView& chunk, double begin, double end)
+  {
+    const auto first = std::lower_bound(chunk.t, chunk.t + chunk.size, begin);
+    const auto last  = std::lower_bound(first, chunk.t + chunk.size, end);
+    const auto index = static_cast<std::size_t>(first - chunk.t);
+    MappedTimeSerie::Writer writer{file, layout};
+    return writer.append(first, chunk.row(index),
+                         static_cast<std::size_t>(last - first)) &&
+           writer.commit();
+  }
+
+  QString product_key(const IDataProvider* provider, const QVariantHash& data)
+  {
+    auto keys = data.keys();
+    keys.sort();
+    QByteArray text = provider->name().toUtf8();
+    for(const auto& key : keys)
+      text += '\n' + key.toUtf8() + '=' + data[key].toString().toUtf8();
+    return QString::fromLatin1(
+        QCryptographicHash::hash(text, QCryptographicHash::Sha1).toHex());
+  }
+} // namespace
+
+SampleCache::SampleCache(const QString& directory, qint64 budget,
+                         double bucket)
+    : m_directory{directory}, m_budget{budget}, m_bucket{bucket}
+{
+  // least recently used last, as left by previous sessions
+  std::vector<QFileInfo> chunks;
+  QDirIterator it{m_directory, {QStringLiteral("*.chunk")}, QDir::Files,
+                  QDirIterator::Subdirectories};
+  while(it.hasNext())
+  {
+    it.next();
+    chunks.push_back(it.fileInfo());
+  }
+  std::sort(std::begin(chunks), std::end(chunks),
+            [](const auto& a, const auto& b) {
+              return a.lastModified() > b.lastModified();
+            });
+  for(const auto& chunk : chunks)
+  {
+    m_lru.push_back(chunk.filePath());
+    m_chunks.insert(chunk.filePath(),
+                    {std::prev(std::end(m_lru)), chunk.size()});
+    m_size += chunk.size();
+  }
+  std::lock_guard<std::mutex> lock{m_mutex};
+  evict();
+}
+
+QString SampleCache::defaultDirectory()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         QStringLiteral("/samples");
+}
+
+TimeSeries::ITimeSerie*
+SampleCache::getData(IDataProvider* provider,
+                     const DataProviderParameters& parameters)
+{
+  const auto& range = parameters.m_Range;
+  if(std::isnan(range.m_TStart) || std::isnan(range.m_TEnd) ||
+     !(range.m_TEnd >= range.m_TStart))
+    return provider->getData(parameters);
+  const auto first =
+      static_cast<qint64>(std::floor(range.m_TStart / m_bucket));
+  const auto last = static_cast<qint64>(std::floor(range.m_TEnd / m_bucket));
+  if(last - first >= max_buckets) return provider->getData(parameters);
+
+  const auto product = product_key(provider, parameters.m_Data);
+  // buckets ended more recently than the settle delay may still be filled in,
+  // they are neither stored nor fetched beyond the requested range
+  const auto settled = static_cast<double>(QDateTime::currentSecsSinceEpoch()) -
+                       provider->cacheSettleDelay();
+  const auto last_settled =
+      static_cast<qint64>(std::floor(settled / m_bucket)) - 1;
+  // cached and fetched chunks are only stitched once all of them are known
+  std::vector<MappedTimeSerie> mapped;
+  std::vector<std::unique_ptr<TimeSeries::ITimeSerie>> fetched;
+  std::vector<TimeSerieView> parts;
+  TimeSerieLayout layout;
+  auto add = [&](const TimeSerieLayout& chunk_layout,
+                 const TimeSerieView& chunk) {
+    if(layout.type == DataSeriesType::NONE) layout = chunk_layout;
+    parts.push_back(chunk.slice(range.m_TStart, range.m_TEnd));
+  };
+
+  bool incompatible = false;
+  // fetches [begin, end] in one call, stores buckets [store_first, store_last]
+  auto fetch = [&](double begin, double end, qint64 store_first,
+                   qint64 store_last) {
+    DataProviderParameters p{
+        {begin, end}, parameters.m_Data, parameters.m_Cancellation};
+    std::unique_ptr<TimeSeries::ITimeSerie> ts{provider->getData(p)};
+    if(!ts || parameters.m_Cancellation.cancelled()) return false;
+    TimeSerieLayout chunk_layout;
+    TimeSerieView chunk;
+    DataSeriesTypeUtils::visit(ts.get(), [&](auto* serie) {
+      chunk_layout = TimeSerieLayout::of(*serie);
+      chunk        = serie->view();
+    });
+    if(chunk_layout.type == DataSeriesType::NONE ||
+       !compatible(layout, chunk_layout))
+    {
+      incompatible = true;
+      return false;
+    }
+    for(auto bucket = store_first; bucket <= store_last; bucket++)
+    {
+      const auto bucket_begin = static_cast<double>(bucket) * m_bucket;
+      const auto file         = chunkFile(product, bucket);
+      if(write(file, chunk_layout, chunk, bucket_begin,
+               bucket_begin + m_bucket))
+        added(file, QFileInfo{file}.size());
+    }
+    // chunk views ts samples, which stay where they are once moved
+    fetched.push_back(std::move(ts));
+    add(chunk_layout, chunk);
+    return true;
+  };
+  // fetches the missing buckets [run_first, run_last], whole when they get
+  // stored, only over the requested range otherwise
+  auto fetch_run = [&](qint64 run_first, qint64 run_last) {
+    const auto run_begin  = static_cast<double>(run_first) * m_bucket;
+    const auto run_end    = static_cast<double>(run_last + 1) * m_bucket;
+    const auto store_last = std::min(run_last, last_settled);
+    auto begin            = std::max(range.m_TStart, run_begin);
+    const auto end        = std::min(range.m_TEnd, run_end);
+    if(run_first <= store_last)
+    {
+      const auto store_end = static_cast<double>(store_last + 1) * m_bucket;
+      // whole buckets may fail where the request alone doesn't (e.g. before
+      // the mission start), the requested part is then fetched uncached
+      if(!fetch(run_begin, store_end, run_first, store_last) &&
+         (incompatible || parameters.m_Cancellation.cancelled() ||
+          !fetch(begin, std::min(end, store_end), 0, -1)))
+        return false;
+      if(store_last == run_last || store_end >= end) return true;
+      begin = store_end;
+    }
+    return fetch(begin, end, 0, -1);
+  };
+  auto read = [&](const QString& file) {
+    MappedTimeSerie chunk{file};
+    if(!chunk.isValid()) return ReadStatus::Invalid;
+    if(!compatible(layout, chunk.layout())) return ReadStatus::Incompatible;
+    mapped.push_back(std::move(chunk));
+    add(mapped.back().layout(), mapped.back().view());
+    return ReadStatus::Ok;
+  };
+  // a product whose shape changes over time bypasses the cache
+  auto failed = [&]() {
+    return incompatible ? provider->getData(parameters) : nullptr;
+  };
+
+  std::optional<qint64> missing;
+  for(auto bucket = first; bucket <= last + 1; bucket++)
+  {
+    const auto file = chunkFile(product, bucket);
+    if(bucket <= last && !contains(file))
+    {
+      if(!missing) missing = bucket;
+      continue;
+    }
+    // missing buckets go first, chunks are stitched in time order
+    if(missing && !fetch_run(*missing, bucket - 1)) return failed();
+    missing.reset();
+    if(bucket > last) break;
+    switch(read(file))
+    {
+      case ReadStatus::Ok: touched(file); break;
+      // valid chunks of another shape are kept, the request goes around
+      case ReadStatus::Incompatible: return provider->getData(parameters);
+      case ReadStatus::Invalid:
+        removed(file);
+        if(!fetch_run(bucket, bucket)) return failed();
+        break;
+    }
+  }
+  return TimeSeriesUtils::merge(std::move(parts), layout);
+}
+
+qint64 SampleCache::size()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_size;
+}
+
+void SampleCache::clear()
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  for(const auto& file : m_lru)
+    QFile::remove(file);
+  m_lru.clear();
+  m_chunks.clear();
+  m_size = 0;
+}
+
+QString SampleCache::chunkFile(const QString& product, qint64 bucket) const
+{
+  return m_directory + '/' + product + '/' + QString::number(bucket) +
+         QStringLiteral(".chunk");
+}
+
+bool SampleCache::contains(const QString& file)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_chunks.contains(file);
+}
+
+void SampleCache::touched(const QString& file)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if(auto it = m_chunks.find(file); it != m_chunks.end())
+      m_lru.splice(std::begin(m_lru), m_lru, it->first);
+  }
+  // keeps the usage order for the next sessions
+  QFile chunk{file};
+  if(chunk.open(QIODevice::ReadOnly))
+    chunk.setFileTime(QDateTime::currentDateTime(),
+                      QFileDevice::FileModificationTime);
+}
+
+void SampleCache::added(const QString& file, qint64 size)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if(auto it = m_chunks.find(file); it != m_chunks.end())
+  {
+    // rewritten by a concurrent request
+    m_size += size - it->second;
+    it->second = size;
+    m_lru.splice(std::begin(m_lru), m_lru, it->first);
+  }
+  else
+  {
+    m_lru.push_front(file);
+    m_chunks.insert(file, {std::begin(m_lru), size});
+    m_size += size;
+  }
+  evict();
+}
+
+void SampleCache::removed(const QString& file)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if(auto it = m_chunks.find(file); it != m_chunks.end())
+  {
+    m_size -= it->second;
+    m_lru.erase(it->first);
+    m_chunks.erase(it);
+  }
+  QFile::remove(file);
+}
+
+void SampleCache::evict()
+{
+  // the most recent chunk stays, even above budget
+  while(m_size > m_budget && std::size(m_lru) > 1)
+  {
+    const auto file = m_lru.back();
+    m_lru.pop_back();
+    m_size -= m_chunks.take(file).second;
+    QFile::remove(file);
+  }
+}
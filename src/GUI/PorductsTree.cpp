@@ -35,14 +35,9 @@ ProductsTree::ProductsTree(QWidget* parent)
   m_model_proxy.setSourceModel(&SciQLopCore::dataSources());
   ui->treeView->setModel(&m_model_proxy);
   ui->treeView->setDragEnabled(true);
-  m_model_proxy.setFilterRole(Qt::DisplayRole);
-  m_model_proxy.setRecursiveFilteringEnabled(true);
-  m_model_proxy.setAutoAcceptChildRows(true);
 
   connect(ui->filterLineEdit, &QLineEdit::textChanged, &m_model_proxy,
-          [this](const QString& filter) {
-            m_model_proxy.setFilterFixedString(filter);
-          });
+          &ProductsFilterModel::setQuery);
 
   QAction* expandAll   = new QAction("Expand all");
   QAction* collapseAll = new QAction("Collapse all");
@@ -63,6 +58,7 @@ ProductsTree::ProductsTree(QWidget* parent)
   QCompleter* completer = new QCompleter(this);
   completer->setModel(SciQLopCore::dataSources().completionModel());
   completer->setCaseSensitivity(Qt::CaseInsensitive);
+  completer->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
   ui->filterLineEdit->setCompleter(completer);
 }
 
@@ -0,0 +1,102 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "SciQLopCore/GUI/ProductsFilterModel.hpp"
+
+#include "SciQLopCore/DataSource/DataSourceItem.hpp"
+#include "SciQLopCore/DataSource/DataSources.hpp"
+
+ProductsFilterModel::ProductsFilterModel(QObject* parent)
+    : QSortFilterProxyModel{parent}
+{
+  m_refreshTimer.setSingleShot(true);
+  m_refreshTimer.setInterval(0);
+  connect(&m_refreshTimer, &QTimer::timeout, this,
+          &ProductsFilterModel::refresh);
+}
+
+void ProductsFilterModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+  if(m_dataSources) disconnect(m_dataSources, nullptr, this, nullptr);
+  QSortFilterProxyModel::setSourceModel(sourceModel);
+  m_dataSources = qobject_cast<DataSources*>(sourceModel);
+  if(m_dataSources)
+  {
+    // matches are pointers, they must follow the tree content, connected
+    // after the proxy so its own mapping is updated first. Registering an
+    // inventory emits one insertion per folder, refresh once they are all in
+    connect(m_dataSources, &QAbstractItemModel::rowsInserted, this,
+            &ProductsFilterModel::scheduleRefresh);
+    connect(m_dataSources, &QAbstractItemModel::rowsRemoved, this,
+            &ProductsFilterModel::scheduleRefresh);
+    connect(m_dataSources, &QAbstractItemModel::modelReset, this,
+            &ProductsFilterModel::scheduleRefresh);
+  }
+  refresh();
+}
+
+void ProductsFilterModel::setQuery(const QString& query)
+{
+  if(query == m_query) return;
+  m_query = query;
+  refresh();
+}
+
+void ProductsFilterModel::scheduleRefresh()
+{
+  // without query every row is accepted, the proxy maps new rows by itself.
+  // Until the refresh runs matches may hold removed items, they are only
+  // compared, never dereferenced
+  if(!m_query.isEmpty()) m_refreshTimer.start();
+}
+
+void ProductsFilterModel::refresh()
+{
+  m_refreshTimer.stop();
+  m_matches.clear();
+  m_ancestors.clear();
+  if(m_dataSources && !m_query.isEmpty())
+  {
+    m_matches = m_dataSources->search(m_query);
+    for(const auto item : m_matches)
+    {
+      for(auto parent = item->parentItem();
+          parent && !m_ancestors.contains(parent);
+          parent = parent->parentItem())
+        m_ancestors.insert(parent);
+    }
+  }
+  invalidateFilter();
+}
+
+bool ProductsFilterModel::filterAcceptsRow(
+    int source_row, const QModelIndex& source_parent) const
+{
+  if(m_query.isEmpty()) return true;
+  const auto index = sourceModel()->index(source_row, 0, source_parent);
+  const auto item =
+      static_cast<const DataSourceItem*>(index.internalPointer());
+  if(item == nullptr) return false;
+  if(m_ancestors.contains(item)) return true;
+  for(auto node = item; node; node = node->parentItem())
+    if(m_matches.contains(node)) return true;
+  return false;
+}
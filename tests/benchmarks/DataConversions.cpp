@@ -0,0 +1,79 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "generators.hpp"
+
+#include <QTemporaryDir>
+#include <SciQLopCore/Data/DataConverters.hpp>
+#include <SciQLopCore/Data/MappedTimeSerie.hpp>
+#include <catch2/catch.hpp>
+#include <memory>
+#include <string>
+
+template<DataSeriesType ds_type>
+void benchmark_conversion(const std::string& name, std::size_t size)
+{
+  auto ts = generators::make<ds_type>(size);
+  BENCHMARK(name + " to_data_t " + std::to_string(size))
+  {
+    return DataConverters::to_data_t<ds_type>(ts.get());
+  };
+}
+
+template<DataSeriesType ds_type>
+void benchmark_mapped_slice(const std::string& name, std::size_t size)
+{
+  QTemporaryDir dir;
+  const auto file = dir.filePath("serie");
+  auto ts         = generators::make<ds_type>(size);
+  REQUIRE(MappedTimeSerie::write(file, ts.get()));
+  const MappedTimeSerie mapped{file};
+  REQUIRE(mapped.isValid());
+  // a tenth of the serie, the rest is never paged in
+  const auto delta = mapped.stop() - mapped.start();
+  const auto start = mapped.start() + delta * 0.45;
+  const auto stop  = mapped.start() + delta * 0.55;
+  BENCHMARK(name + " mapped slice " + std::to_string(size))
+  {
+    return std::unique_ptr<TimeSeries::ITimeSerie>{mapped.slice(start, stop)};
+  };
+}
+
+void benchmark_conversions(std::size_t size)
+{
+  benchmark_mapped_slice<DataSeriesType::VECTOR>("vector", size);
+  benchmark_conversion<DataSeriesType::SCALAR>("scalar", size);
+  benchmark_conversion<DataSeriesType::VECTOR>("vector", size);
+  benchmark_conversion<DataSeriesType::MULTICOMPONENT>("multicomponent",
+                                                       size);
+  benchmark_conversion<DataSeriesType::SPECTROGRAM>("spectrogram", size);
+}
+
+TEST_CASE("Time series to plot data conversions", "[conversions]")
+{
+  benchmark_conversions(GENERATE(from_range(generators::default_sizes())));
+}
+
+TEST_CASE("Time series to plot data conversions, 1e8 samples",
+          "[.][huge][conversions]")
+{
+  benchmark_conversions(generators::huge_size);
+}
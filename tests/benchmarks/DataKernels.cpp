@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "generators.hpp"
+
+#include <SciQLopCore/Data/DataCache.hpp>
+#include <SciQLopCore/Data/DataConverters.hpp>
+#include <SciQLopCore/Data/Decimation.hpp>
+#include <SciQLopCore/Data/Regridding.hpp>
+#include <SciQLopCore/Data/TimePyramid.hpp>
+#include <SciQLopCore/Data/TimeSerieMerge.hpp>
+#include <SciQLopCore/Data/TimeSeriesUtils.hpp>
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <optional>
+#include <string>
+
+// typical plot size
+constexpr std::size_t plot_width  = 2000;
+constexpr std::size_t plot_height = 500;
+
+void benchmark_kernels(std::size_t size)
+{
+  const auto suffix = " " + std::to_string(size);
+  const auto vector = DataConverters::to_data_t<DataSeriesType::VECTOR>(
+      generators::vector(size).get());
+  const DateTimeRange range{vector.first.front(), vector.first.back()};
+
+  BENCHMARK("axis_analysis" + suffix)
+  {
+    return TimeSeriesUtils::axis_analysis<TimeSeriesUtils::IsLinear,
+                                          TimeSeriesUtils::CheckMedian>(
+        vector.first);
+  };
+
+  BENCHMARK_ADVANCED("m4 decimation" + suffix)
+  (Catch::Benchmark::Chronometer meter)
+  {
+    std::vector<DataConverters::data_t> inputs(meter.runs(), vector);
+    meter.measure([&](int i) {
+      return Decimation::m4(std::move(inputs[i]), range, plot_width);
+    });
+  };
+
+  BENCHMARK_ADVANCED("cache hit" + suffix)
+  (Catch::Benchmark::Chronometer meter)
+  {
+    DataCache cache{3};
+    auto fetch = [&vector](const DateTimeRange&) {
+      return std::optional{vector};
+    };
+    cache.get(range, fetch);
+    const DateTimeRange zoomed{range.m_TStart + range.delta() / 4.,
+                               range.m_TEnd - range.delta() / 4.};
+    meter.measure([&]() { return cache.get(zoomed, fetch); });
+  };
+
+  BENCHMARK("time pyramid insert" + suffix)
+  {
+    TimePyramid pyramid{3};
+    pyramid.insert(vector, range);
+    return pyramid.size();
+  };
+
+  BENCHMARK_ADVANCED("time pyramid hit" + suffix)
+  (Catch::Benchmark::Chronometer meter)
+  {
+    TimePyramid pyramid{3};
+    pyramid.insert(vector, range);
+    const DateTimeRange zoomed{range.m_TStart + range.delta() / 4.,
+                               range.m_TEnd - range.delta() / 4.};
+    meter.measure([&]() { return pyramid.get(zoomed, plot_width); });
+  };
+
+  // adjacent chunks overlapping by a few samples, as fetched by the caches
+  const auto scalar_ts = generators::scalar(size);
+  const auto scalar    = scalar_ts->view();
+  std::vector<TimeSerieView> chunks;
+  constexpr std::size_t chunk_count = 100;
+  const auto chunk_size = scalar.size / chunk_count;
+  for(auto i = 0UL; i < chunk_count && chunk_size != 0; i++)
+  {
+    const auto first = i * chunk_size;
+    const auto last  = std::min(scalar.size, first + chunk_size + 8);
+    chunks.push_back({scalar.t + first, scalar.row(first), last - first, 1});
+  }
+  BENCHMARK("merge 100 chunks" + suffix)
+  {
+    return TimeSeriesUtils::merge<ScalarTimeSerie>(
+        chunks, TimeSerieLayout::of(*scalar_ts));
+  };
+
+  const auto spectro_ts = generators::spectrogram(size);
+  const auto spectro =
+      DataConverters::to_data_t<DataSeriesType::SPECTROGRAM>(spectro_ts.get());
+  const std::vector<double> channels{std::cbegin(spectro_ts->y_axis()),
+                                     std::cend(spectro_ts->y_axis())};
+  if(!std::empty(spectro.first))
+  {
+    const DateTimeRange spectro_range{spectro.first.front(),
+                                      spectro.first.back()};
+    BENCHMARK("spectrogram regridding" + suffix)
+    {
+      return Regridding::regrid(spectro, channels, spectro_range, plot_width,
+                                plot_height, true, std::nan(""));
+    };
+  }
+}
+
+TEST_CASE("Plot data kernels", "[kernels]")
+{
+  benchmark_kernels(GENERATE(from_range(generators::default_sizes())));
+}
+
+TEST_CASE("Plot data kernels, 1e8 samples", "[.][huge][kernels]")
+{
+  benchmark_kernels(generators::huge_size);
+}
@@ -0,0 +1,120 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include <SciQLopCore/Common/Product.hpp>
+#include <SciQLopCore/DataSource/DataSources.hpp>
+#include <SciQLopCore/DataSource/IDataProvider.hpp>
+#include <SciQLopCore/SciQLopCore.hpp>
+#include <catch2/catch.hpp>
+#include <memory>
+#include <vector>
+
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define HAS_HEAP_USAGE
+// bytes allocated on the heap, mmapped chunks included
+std::size_t heap_usage()
+{
+  const auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+#endif
+#endif
+
+// 10 missions x 100 instruments x 100 products
+constexpr int missions    = 10;
+constexpr int instruments = 100;
+constexpr int products    = 100;
+
+std::vector<std::unique_ptr<Product>> make_products(const QString& root)
+{
+  std::vector<std::unique_ptr<Product>> result;
+  result.reserve(missions * instruments * products);
+  for(int m = 0; m < missions; m++)
+    for(int i = 0; i < instruments; i++)
+      for(int p = 0; p < products; p++)
+        result.push_back(std::make_unique<Product>(
+            QString("/%1/mission_%2/instrument_%3/product_%4")
+                .arg(root)
+                .arg(m)
+                .arg(i)
+                .arg(p),
+            std::vector<std::string>{}, DataSeriesType::VECTOR,
+            QMap<QString, QString>{{"mission", QString::number(m)},
+                                   {"units", "nT"},
+                                   {"type", "vector"}}));
+  return result;
+}
+
+QVector<Product*> raw(const std::vector<std::unique_ptr<Product>>& products)
+{
+  QVector<Product*> result;
+  for(const auto& p : products)
+    result.push_back(p.get());
+  return result;
+}
+
+TEST_CASE("Products inventory", "[datasources]")
+{
+  const auto products = make_products("bench");
+  const auto list     = raw(products);
+
+  BENCHMARK_ADVANCED("addProducts 100k")
+  (Catch::Benchmark::Chronometer meter)
+  {
+    std::vector<std::unique_ptr<DataSources>> sources(meter.runs());
+    for(auto& s : sources)
+      s = std::make_unique<DataSources>();
+    meter.measure([&](int i) { sources[i]->addProducts("bench", list); });
+  };
+
+  IDataProvider provider;
+  SciQLopCore::dataSources().addProducts(provider.name(), list);
+  BENCHMARK("provider lookup")
+  {
+    return SciQLopCore::dataSources().provider(
+        "/bench/mission_5/instrument_50/product_50");
+  };
+  BENCHMARK("nodeData lookup")
+  {
+    return SciQLopCore::dataSources().nodeData(
+        "/bench/mission_9/instrument_99/product_99");
+  };
+}
+
+TEST_CASE("Products inventory footprint", "[datasources]")
+{
+#ifdef HAS_HEAP_USAGE
+  const auto inventory = make_products("footprint");
+  const auto list      = raw(inventory);
+  const auto before    = heap_usage();
+  auto sources         = std::make_unique<DataSources>();
+  sources->addProducts("footprint", list);
+  // products, instruments, missions, the top folder and the root
+  const auto items = missions * instruments * products +
+                     missions * instruments + missions + 2;
+  // tree items, their metadata and the search index
+  WARN("heap bytes per item: " << (heap_usage() - before) / items);
+#else
+  WARN("heap usage isn't available on this platform");
+#endif
+}
@@ -0,0 +1,113 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#pragma once
+#include <SciQLopCore/Data/DataSeriesType.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+/**
+ * Synthetic time series for benchmarks, sizes are given in values so every
+ * DataSeriesType uses the same amount of memory for a given size.
+ */
+namespace generators
+{
+  constexpr std::size_t multicomponent_count = 8;
+  constexpr std::size_t spectrogram_channels = 32;
+
+  // 1 Hz starting at 2020-09-13
+  inline std::vector<double> time_axis(std::size_t count)
+  {
+    std::vector<double> t(count);
+    std::iota(std::begin(t), std::end(t), 1.6e9);
+    return t;
+  }
+
+  inline std::vector<double> values(std::size_t count)
+  {
+    std::vector<double> v(count);
+    for(auto i = 0UL; i < count; i++)
+      v[i] = std::sin(static_cast<double>(i) * 1e-3) * 100.;
+    return v;
+  }
+
+  inline std::unique_ptr<ScalarTimeSerie> scalar(std::size_t size)
+  {
+    return std::make_unique<ScalarTimeSerie>(time_axis(size), values(size));
+  }
+
+  inline std::unique_ptr<VectorTimeSerie> vector(std::size_t size)
+  {
+    const auto count = size / 3;
+    std::vector<VectorTimeSerie::raw_value_type> v(count);
+    for(auto i = 0UL; i < count; i++)
+    {
+      const auto phase = static_cast<double>(i) * 1e-3;
+      v[i]             = {std::sin(phase), std::cos(phase), phase};
+    }
+    return std::make_unique<VectorTimeSerie>(time_axis(count), std::move(v));
+  }
+
+  inline std::unique_ptr<MultiComponentTimeSerie>
+  multicomponent(std::size_t size)
+  {
+    const auto count = size / multicomponent_count;
+    return std::make_unique<MultiComponentTimeSerie>(
+        time_axis(count), values(count * multicomponent_count),
+        std::initializer_list<std::size_t>{count, multicomponent_count});
+  }
+
+  inline std::unique_ptr<SpectrogramTimeSerie> spectrogram(std::size_t size)
+  {
+    const auto count = size / spectrogram_channels;
+    std::vector<double> y(spectrogram_channels);
+    for(auto i = 0UL; i < spectrogram_channels; i++)
+      y[i] = std::pow(10., 1. + 3. * static_cast<double>(i) /
+                                    static_cast<double>(spectrogram_channels));
+    return std::make_unique<SpectrogramTimeSerie>(
+        time_axis(count), std::move(y), values(count * spectrogram_channels),
+        std::initializer_list<std::size_t>{count, spectrogram_channels}, 1.,
+        1.);
+  }
+
+  template<DataSeriesType ds_type>
+  inline std::unique_ptr<TimeSeries::ITimeSerie> make(std::size_t size)
+  {
+    if constexpr(ds_type == DataSeriesType::SCALAR) return scalar(size);
+    if constexpr(ds_type == DataSeriesType::VECTOR) return vector(size);
+    if constexpr(ds_type == DataSeriesType::MULTICOMPONENT)
+      return multicomponent(size);
+    if constexpr(ds_type == DataSeriesType::SPECTROGRAM)
+      return spectrogram(size);
+  }
+
+  // 1e8 samples are only run on demand, see the [huge] tag
+  inline auto default_sizes()
+  {
+    return std::vector<std::size_t>{1'000, 10'000, 100'000, 1'000'000,
+                                    10'000'000};
+  }
+  constexpr std::size_t huge_size = 100'000'000;
+} // namespace generators
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+"""Measures how fast NumPy arrays are turned into SciQLop time series.
+
+Results are written as JSON, one entry per series type and size.
+"""
+import argparse
+import json
+import timeit
+import numpy as np
+from SciQLopBindings import ScalarTimeSerie, VectorTimeSerie, MultiComponentTimeSerie, SpectrogramTimeSerie
+
+SIZES = [1_000, 10_000, 100_000, 1_000_000, 10_000_000]
+HUGE_SIZE = 100_000_000
+
+
+def make(kind, size):
+    if kind == "scalar":
+        return lambda: ScalarTimeSerie(np.arange(size) * 1., np.ones(size))
+    if kind == "vector":
+        n = size // 3
+        return lambda: VectorTimeSerie(np.arange(n) * 1., np.ones((n, 3)))
+    if kind == "multicomponent":
+        n = size // 8
+        return lambda: MultiComponentTimeSerie(np.arange(n) * 1., np.ones((n, 8)))
+    n = size // 32
+    y = np.logspace(1, 4, 32)
+    return lambda: SpectrogramTimeSerie(np.arange(n) * 1., y, np.ones((n, 32)))
+
+
+def run(sizes):
+    results = []
+    for kind in ("scalar", "vector", "multicomponent", "spectrogram"):
+        for size in sizes:
+            build = make(kind, size)
+            repeat = max(3, min(100, 10_000_000 // size))
+            timings = timeit.repeat(build, number=1, repeat=repeat)
+            results.append({"name": f"{kind} numpy ingestion", "size": size,
+                            "min_s": min(timings), "mean_s": sum(timings) / len(timings),
+                            "samples_per_s": size / min(timings)})
+    return results
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--output', default=None)
+    parser.add_argument('--huge', action='store_true', help='also run 1e8 samples')
+    args = parser.parse_args()
+    results = json.dumps(run(SIZES + ([HUGE_SIZE] if args.huge else [])), indent=2)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(results)
+    print(results)
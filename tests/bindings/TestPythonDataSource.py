@@ -1,6 +1,9 @@
 #!/usr/bin/env python
 import unittest
-from SciQLopBindings import DataProvider, Product, SciQLopCore, ScalarTimeSerie, DataSeriesType
+from SciQLopBindings import DataProvider, Product, SciQLopCore, ScalarTimeSerie, FutureTimeSerie, MappedTimeSerie, DataSeriesType
+import os
+import tempfile
+from concurrent.futures import Future
 import numpy as np
 
 
@@ -27,5 +30,107 @@ class AProvider(unittest.TestCase):
         self.assertIsNone(SciQLopCore.dataSources().provider("/another/scalar"))
 
 
+class AnInventory(unittest.TestCase):
+    def test_can_be_saved_and_restored(self):
+        provider = MyProvider("/inventory/scalar")
+        self.assertTrue(provider.save_inventory("v1"))
+        provider.remove_products(["/inventory/scalar"])
+        self.assertIsNone(SciQLopCore.dataSources().provider("/inventory/scalar"))
+        self.assertFalse(provider.load_inventory("v2"))
+        self.assertTrue(provider.load_inventory("v1"))
+        self.assertEqual(SciQLopCore.dataSources().provider("/inventory/scalar"), provider)
+
+    def test_only_adds_missing_products(self):
+        provider = MyProvider("/delta/scalar")
+        self.assertTrue(provider.save_inventory("v1"))
+        self.assertTrue(provider.load_inventory("v1"))
+        provider.register_products([Product("/delta/scalar",[], DataSeriesType.SCALAR,{"type":"scalar"})])
+        self.assertEqual(provider.products(), ["/delta/scalar"])
+
+    def test_updates_registered_products(self):
+        provider = MyProvider("/update/scalar")
+        provider.register_products([Product("/update/scalar",[], DataSeriesType.SCALAR,{"type":"scalar", "units":"nT"})])
+        self.assertEqual(provider.products(), ["/update/scalar"])
+        self.assertEqual(provider.product_metadata("/update/scalar"), {"type":"scalar", "units":"nT"})
+        other = MyProvider("/update/scalar")
+        self.assertEqual(SciQLopCore.dataSources().provider("/update/scalar"), other)
+        self.assertEqual(provider.products(), [])
+        self.assertEqual(other.products(), ["/update/scalar"])
+
+
+def child_names(model, parent=None):
+    if parent is None:
+        return [model.index(row, 0).data() for row in range(model.rowCount())]
+    return [model.index(row, 0, parent).data() for row in range(model.rowCount(parent))]
+
+
+def child_index(model, names):
+    index = None
+    for name in names:
+        row = child_names(model, index).index(name)
+        index = model.index(row, 0) if index is None else model.index(row, 0, index)
+    return index
+
+
+class AnUnloadedProvider(unittest.TestCase):
+    def test_leaves_the_other_provider_products(self):
+        ds = SciQLopCore.dataSources()
+        unloaded = MyProvider("/unload/common/a1")
+        unloaded.register_products([Product(path,[], DataSeriesType.SCALAR,{"type":"scalar"})
+                                    for path in ("/unload/common/a2", "/unload/common/x/a3", "/unload/only_a/a4")])
+        # a product with the same name as the folder of the first provider
+        kept = MyProvider("/unload/common/b1")
+        kept.register_products([Product("/unload/common/x",[], DataSeriesType.SCALAR,{"type":"scalar"})])
+        self.assertEqual(child_names(ds, child_index(ds, ["unload", "common"])), ["a1", "a2", "x", "b1", "x"])
+        self.assertIsNone(ds.provider("/unload/common/x"))
+
+        removed = []
+        def on_removed(parent, first, last):
+            removed.append((parent.data(), first, last))
+        ds.rowsRemoved.connect(on_removed)
+        del unloaded
+        ds.rowsRemoved.disconnect(on_removed)
+
+        # one signal per contiguous run, emptied folders go in a second pass
+        self.assertEqual(sorted(removed), [("common", 0, 0), ("common", 0, 1), ("only_a", 0, 0),
+                                           ("unload", 1, 1), ("x", 0, 0)])
+        self.assertEqual(child_names(ds, child_index(ds, ["unload"])), ["common"])
+        self.assertEqual(child_names(ds, child_index(ds, ["unload", "common"])), ["b1", "x"])
+        self.assertEqual(ds.provider("/unload/common/b1"), kept)
+        self.assertEqual(ds.provider("/unload/common/x"), kept)
+        self.assertIsNone(ds.provider("/unload/common/a1"))
+        self.assertIsNone(ds.provider("/unload/common/x/a3"))
+        self.assertEqual(sorted(kept.products()), ["/unload/common/b1", "/unload/common/x"])
+
+
+class AMappedTimeSerie(unittest.TestCase):
+    def test_can_be_written_mapped_and_sliced(self):
+        with tempfile.TemporaryDirectory() as folder:
+            path = os.path.join(folder, "serie")
+            self.assertTrue(MappedTimeSerie.write(path, ScalarTimeSerie(np.arange(100)*1., np.arange(100)*1.)))
+            mapped = MappedTimeSerie(path)
+            self.assertTrue(mapped.is_valid())
+            self.assertEqual(mapped.type(), DataSeriesType.SCALAR)
+            self.assertEqual(mapped.size(), 100)
+            self.assertEqual((mapped.start(), mapped.stop()), (0., 99.))
+            self.assertIsNotNone(mapped.slice(10., 20.))
+            del mapped
+
+    def test_rejects_missing_files(self):
+        self.assertFalse(MappedTimeSerie("/does/not/exist").is_valid())
+
+
+class AFutureTimeSerie(unittest.TestCase):
+    def test_accepts_futures_and_coroutines(self):
+        async def fetch():
+            return ScalarTimeSerie(np.arange(10)*1., np.arange(10)*1.)
+        self.assertIsNotNone(FutureTimeSerie(Future()))
+        self.assertIsNotNone(FutureTimeSerie(fetch()))
+
+    def test_rejects_anything_else(self):
+        with self.assertRaises(TypeError):
+            FutureTimeSerie(42)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,186 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include <SciQLopCore/Data/DataCache.hpp>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+using data_t = DataCache::data_t;
+
+namespace
+{
+  // one sample per second, component c holds t + c * 1e6
+  data_t make_samples(const DateTimeRange& range, std::size_t components)
+  {
+    data_t data;
+    for(auto t = std::ceil(range.m_TStart); t <= range.m_TEnd; t += 1.)
+      data.first.push_back(t);
+    const auto size = std::size(data.first);
+    data.second.resize(size * components);
+    for(auto comp = 0UL; comp < components; comp++)
+      for(auto i = 0UL; i < size; i++)
+        data.second[comp * size + i] =
+            data.first[i] + static_cast<double>(comp) * 1e6;
+    return data;
+  }
+
+  // records the requested ranges, fails while failing is set
+  struct Provider
+  {
+    std::size_t components;
+    bool failing = false;
+    std::vector<DateTimeRange> requests;
+
+    auto fetcher()
+    {
+      return [this](const DateTimeRange& range) -> std::optional<data_t> {
+        requests.push_back(range);
+        if(failing) return std::nullopt;
+        return make_samples(range, components);
+      };
+    }
+  };
+
+  void check_samples(const std::optional<data_t>& data,
+                     const DateTimeRange& range, std::size_t components)
+  {
+    REQUIRE(data);
+    const auto expected = make_samples(range, components);
+    CHECK(data->first == expected.first);
+    CHECK(data->second == expected.second);
+  }
+} // namespace
+
+TEST_CASE("Data cache only fetches missing ranges", "[cache]")
+{
+  constexpr std::size_t components = 3;
+  Provider provider{components};
+  DataCache cache{components};
+  check_samples(cache.get({0., 100.}, provider.fetcher()), {0., 100.},
+                components);
+  REQUIRE(provider.requests == std::vector<DateTimeRange>{{0., 100.}});
+  provider.requests.clear();
+
+  SECTION("Disjoint ranges replace the cache")
+  {
+    check_samples(cache.get({1000., 1100.}, provider.fetcher()),
+                  {1000., 1100.}, components);
+    CHECK(provider.requests == std::vector<DateTimeRange>{{1000., 1100.}});
+    CHECK(cache.range() == DateTimeRange{1000., 1100.});
+  }
+  SECTION("Overlapping ranges are stitched")
+  {
+    // samples at the cache edges are only kept once
+    check_samples(cache.get({50., 150.}, provider.fetcher()), {50., 150.},
+                  components);
+    CHECK(provider.requests == std::vector<DateTimeRange>{{100., 150.}});
+    check_samples(cache.get({-50., 80.}, provider.fetcher()), {-50., 80.},
+                  components);
+    CHECK(provider.requests ==
+          std::vector<DateTimeRange>{{100., 150.}, {-50., 0.}});
+    CHECK(cache.range() == DateTimeRange{-50., 150.});
+  }
+  SECTION("Wider ranges fetch both sides")
+  {
+    check_samples(cache.get({-20., 120.}, provider.fetcher()), {-20., 120.},
+                  components);
+    CHECK(provider.requests ==
+          std::vector<DateTimeRange>{{-20., 0.}, {100., 120.}});
+  }
+  SECTION("Cached ranges aren't fetched again")
+  {
+    check_samples(cache.get({10., 20.5}, provider.fetcher()), {10., 20.5},
+                  components);
+    CHECK(std::empty(provider.requests));
+  }
+}
+
+TEST_CASE("Data cache doesn't keep failed fetches", "[cache]")
+{
+  Provider provider{1};
+  DataCache cache{1};
+  SECTION("Empty cache")
+  {
+    provider.failing = true;
+    CHECK_FALSE(cache.get({0., 100.}, provider.fetcher()));
+    CHECK(std::isnan(cache.range().m_TStart));
+    provider.failing = false;
+    check_samples(cache.get({0., 100.}, provider.fetcher()), {0., 100.}, 1);
+  }
+  SECTION("Missing range")
+  {
+    REQUIRE(cache.get({0., 100.}, provider.fetcher()));
+    provider.failing = true;
+    CHECK_FALSE(cache.get({50., 150.}, provider.fetcher()));
+    CHECK(cache.range() == DateTimeRange{0., 100.});
+    // retried once the provider is back
+    provider.failing = false;
+    provider.requests.clear();
+    check_samples(cache.get({50., 150.}, provider.fetcher()), {50., 150.}, 1);
+    CHECK(provider.requests == std::vector<DateTimeRange>{{100., 150.}});
+  }
+  SECTION("Ranges without samples are cached")
+  {
+    auto empty = [&provider](const DateTimeRange& range) {
+      provider.requests.push_back(range);
+      return std::optional<data_t>{data_t{}};
+    };
+    const auto data = cache.get({0., 100.}, empty);
+    REQUIRE(data);
+    CHECK(std::empty(data->first));
+    CHECK(cache.range() == DateTimeRange{0., 100.});
+    provider.requests.clear();
+    CHECK(cache.get({10., 90.}, empty));
+    CHECK(std::empty(provider.requests));
+  }
+}
+
+TEST_CASE("Data cache is trimmed around the last request", "[cache]")
+{
+  Provider provider{2};
+  DataCache cache{2};
+  REQUIRE(cache.get({0., 100.}, provider.fetcher()));
+  SECTION("Within the window")
+  {
+    // 3 times [80, 120] is [40, 160]
+    check_samples(cache.get({80., 120.}, provider.fetcher()), {80., 120.}, 2);
+    CHECK(cache.range() == DateTimeRange{40., 120.});
+  }
+  SECTION("Trimmed samples are fetched again")
+  {
+    check_samples(cache.get({100., 110.}, provider.fetcher()), {100., 110.},
+                  2);
+    CHECK(cache.range() == DateTimeRange{90., 110.});
+    provider.requests.clear();
+    check_samples(cache.get({85., 95.}, provider.fetcher()), {85., 95.}, 2);
+    CHECK(provider.requests == std::vector<DateTimeRange>{{85., 90.}});
+  }
+  SECTION("Custom span factor")
+  {
+    DataCache wide{2, 10.};
+    REQUIRE(wide.get({0., 100.}, provider.fetcher()));
+    // 10 times [100, 110] is [55, 155]
+    REQUIRE(wide.get({100., 110.}, provider.fetcher()));
+    CHECK(wide.range() == DateTimeRange{55., 110.});
+  }
+}
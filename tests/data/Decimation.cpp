@@ -0,0 +1,160 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include <SciQLopCore/Data/Decimation.hpp>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+using data_t = Decimation::data_t;
+
+namespace
+{
+  // irregular sampling, spikes and a few NaNs
+  data_t make_samples(std::size_t size, std::size_t components)
+  {
+    data_t data;
+    auto t = 0.;
+    for(auto i = 0UL; i < size; i++)
+    {
+      data.first.push_back(t);
+      t += 0.5 + static_cast<double>((i * 7) % 5) * 0.25;
+    }
+    data.second.resize(size * components);
+    for(auto comp = 0UL; comp < components; comp++)
+      for(auto i = 0UL; i < size; i++)
+        data.second[comp * size + i] =
+            (i % 97 == 0) ? std::nan("")
+            : (i % (31 + comp) == 0)
+                ? 1000. * static_cast<double>(comp + 1)
+                : std::sin(static_cast<double>(i * (comp + 1)) * 0.01) * 10.;
+    return data;
+  }
+
+  struct bucket_t
+  {
+    std::vector<std::size_t> samples;
+  };
+
+  // brute force bucketing, same rule as Decimation::buckets
+  std::map<long, bucket_t> bucketize(const std::vector<double>& x,
+                                     const DateTimeRange& range,
+                                     std::size_t pixels)
+  {
+    std::map<long, bucket_t> result;
+    const double width = range.delta() / static_cast<double>(pixels);
+    for(auto i = 0UL; i < std::size(x); i++)
+      result[static_cast<long>(std::floor((x[i] - range.m_TStart) / width))]
+          .samples.push_back(i);
+    return result;
+  }
+
+  void check_m4(const data_t& samples, const DateTimeRange& range,
+                std::size_t pixels)
+  {
+    const auto size       = std::size(samples.first);
+    const auto components = std::size(samples.second) / size;
+    const auto result     = Decimation::m4(data_t{samples}, range, pixels);
+    const auto count      = std::size(result.first);
+    REQUIRE(std::size(result.second) == count * components);
+
+    // every kept point is an untouched sample, in time order
+    std::vector<std::size_t> kept;
+    for(auto j = 0UL, i = 0UL; j < count; j++, i++)
+    {
+      while(i < size && samples.first[i] != result.first[j])
+        i++;
+      REQUIRE(i < size);
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        const auto expected = samples.second[comp * size + i];
+        const auto value    = result.second[comp * count + j];
+        CHECK((value == expected ||
+               (std::isnan(value) && std::isnan(expected))));
+      }
+      kept.push_back(i);
+    }
+
+    // samples outside of range make their own buckets
+    const auto buckets = bucketize(samples.first, range, pixels);
+    CHECK(count <= (2 + 2 * components) * std::size(buckets));
+    for(const auto& [index, bucket] : buckets)
+    {
+      std::vector<std::size_t> kept_in_bucket;
+      for(const auto i : kept)
+        if(std::binary_search(std::cbegin(bucket.samples),
+                              std::cend(bucket.samples), i))
+          kept_in_bucket.push_back(i);
+      REQUIRE_FALSE(std::empty(kept_in_bucket));
+      CHECK(kept_in_bucket.front() == bucket.samples.front());
+      CHECK(kept_in_bucket.back() == bucket.samples.back());
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        const double* values = samples.second.data() + comp * size;
+        auto min = std::numeric_limits<double>::infinity();
+        auto max = -min;
+        for(const auto i : bucket.samples)
+        {
+          if(std::isnan(values[i])) continue;
+          min = std::min(min, values[i]);
+          max = std::max(max, values[i]);
+        }
+        if(min > max) continue;
+        auto kept_min = std::numeric_limits<double>::infinity();
+        auto kept_max = -kept_min;
+        for(const auto i : kept_in_bucket)
+        {
+          if(std::isnan(values[i])) continue;
+          kept_min = std::min(kept_min, values[i]);
+          kept_max = std::max(kept_max, values[i]);
+        }
+        CHECK(kept_min == min);
+        CHECK(kept_max == max);
+      }
+    }
+  }
+} // namespace
+
+TEST_CASE("M4 keeps first, min, max and last samples of each bucket", "[m4]")
+{
+  const auto components = GENERATE(as<std::size_t>{}, 1, 3);
+  const auto samples    = make_samples(100000, components);
+  const DateTimeRange full{samples.first.front(), samples.first.back()};
+  const auto range = GENERATE_COPY(
+      full, DateTimeRange{full.m_TStart + full.delta() * 0.2,
+                          full.m_TStart + full.delta() * 0.6});
+  const auto pixels = GENERATE(as<std::size_t>{}, 100, 1000, 10000);
+  check_m4(samples, range, pixels);
+}
+
+TEST_CASE("M4 leaves small series untouched", "[m4]")
+{
+  const auto samples = make_samples(400, 2);
+  const DateTimeRange range{samples.first.front(), samples.first.back()};
+  const auto result = Decimation::m4(data_t{samples}, range, 100);
+  CHECK(result.first == samples.first);
+  CHECK(std::size(result.second) == std::size(samples.second));
+  CHECK_FALSE(Decimation::m4(data_t{samples}, range, 0).first.empty());
+  CHECK(Decimation::m4(data_t{samples}, INVALID_RANGE, 10).first ==
+        samples.first);
+}
@@ -0,0 +1,270 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include "../benchmarks/generators.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <SciQLopCore/Data/MappedTimeSerie.hpp>
+#include <SciQLopCore/Data/TimeSeriesUtils.hpp>
+#include <SciQLopCore/DataSource/IDataProvider.hpp>
+#include <SciQLopCore/DataSource/SampleCache.hpp>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  std::vector<double> times(const TimeSerieView& view)
+  {
+    return {view.t, view.t + view.size};
+  }
+
+  std::vector<double> values(const TimeSerieView& view)
+  {
+    return {view.values, view.values + view.size * view.columns};
+  }
+
+  void check_same(const TimeSerieView& a, const TimeSerieView& b)
+  {
+    REQUIRE(a.size == b.size);
+    REQUIRE(a.columns == b.columns);
+    CHECK(times(a) == times(b));
+    CHECK(values(a) == values(b));
+  }
+
+  // one sample every 10 minutes on an absolute grid, value is t
+  class FakeProvider : public IDataProvider
+  {
+  public:
+    int calls   = 0;
+    bool vector = false;
+    // nothing is served for ranges starting before
+    double mission_start = -INFINITY;
+    std::vector<std::pair<double, double>> requests;
+
+    TimeSeries::ITimeSerie*
+    getData(const DataProviderParameters& parameters) override
+    {
+      calls++;
+      const auto& range = parameters.m_Range;
+      requests.emplace_back(range.m_TStart, range.m_TEnd);
+      if(range.m_TStart < mission_start) return nullptr;
+      std::vector<double> t;
+      for(auto time = std::ceil(range.m_TStart / 600.) * 600.;
+          time <= range.m_TEnd; time += 600.)
+        t.push_back(time);
+      if(vector)
+      {
+        std::vector<Vector> v(std::size(t));
+        for(auto i = 0UL; i < std::size(t); i++)
+          v[i] = {t[i], -t[i], 0.};
+        return new VectorTimeSerie(std::move(t), std::move(v));
+      }
+      auto v = t;
+      return new ScalarTimeSerie(std::move(t), std::move(v));
+    }
+  };
+} // namespace
+
+TEMPLATE_TEST_CASE_SIG("Written series map and slice back unchanged",
+                       "[mapped]", ((DataSeriesType ds_type), ds_type),
+                       DataSeriesType::SCALAR, DataSeriesType::VECTOR,
+                       DataSeriesType::MULTICOMPONENT,
+                       DataSeriesType::SPECTROGRAM)
+{
+  using ts_t = TimeSerieOf<ds_type>;
+  QTemporaryDir dir;
+  const auto file = dir.filePath("serie");
+  const auto ts   = generators::make<ds_type>(9'600);
+  const auto& serie = *dynamic_cast<ts_t*>(ts.get());
+  REQUIRE(MappedTimeSerie::write(file, ts.get()));
+
+  const MappedTimeSerie mapped{file};
+  REQUIRE(mapped.isValid());
+  CHECK(mapped.layout().type == ds_type);
+  CHECK(mapped.layout().sameShape(TimeSerieLayout::of(serie)));
+  check_same(mapped.view(), serie.view());
+
+  // generators copy what they capture, mapped isn't copyable
+  const auto first = mapped.start(), last = mapped.stop();
+  const auto [start, stop] =
+      GENERATE_COPY(std::pair{first + 100.5, last - 10.},
+                    std::pair{first - 10., first + 3.},
+                    std::pair{last + 1., last + 10.});
+  std::unique_ptr<TimeSeries::ITimeSerie> sliced{mapped.slice(start, stop)};
+  REQUIRE(sliced);
+  REQUIRE(DataSeriesTypeUtils::type(sliced.get()) == ds_type);
+  check_same(TimeSeriesUtils::view(sliced.get()), serie.slice(start, stop));
+  if constexpr(ds_type == DataSeriesType::SPECTROGRAM)
+  {
+    const auto& y = dynamic_cast<ts_t*>(sliced.get())->y_axis();
+    CHECK(std::vector<double>(std::cbegin(y), std::cend(y)) ==
+          std::vector<double>(std::cbegin(serie.y_axis()),
+                              std::cend(serie.y_axis())));
+  }
+}
+
+TEST_CASE("Truncated and foreign files aren't mapped", "[mapped]")
+{
+  QTemporaryDir dir;
+  const auto file = dir.filePath("serie");
+  const auto ts   = generators::scalar(1'000);
+  REQUIRE(MappedTimeSerie::write(file, ts.get()));
+  {
+    QFile f{file};
+    REQUIRE(f.open(QIODevice::ReadWrite));
+    f.resize(f.size() - 8);
+  }
+  CHECK_FALSE(MappedTimeSerie{file}.isValid());
+  CHECK_FALSE(MappedTimeSerie{dir.filePath("missing")}.isValid());
+}
+
+TEST_CASE("Sample cache round trip", "[mapped]")
+{
+  QTemporaryDir dir;
+  SampleCache cache{dir.path(), 1LL << 30, 86400.};
+  FakeProvider provider;
+  provider.setCacheSettleDelay(0.);
+  // 2020-01-01 10:00 to 2020-01-03 12:00, three buckets
+  const DataProviderParameters parameters{{1577872800., 1578052800.}, {}, {}};
+  const std::unique_ptr<TimeSeries::ITimeSerie> expected{
+      provider.getData(parameters)};
+  provider.calls = 0;
+
+  std::unique_ptr<TimeSeries::ITimeSerie> first{
+      cache.getData(&provider, parameters)};
+  REQUIRE(first);
+  CHECK(provider.calls == 1);
+  CHECK(cache.size() > 0);
+  check_same(TimeSeriesUtils::view(first.get()),
+             TimeSeriesUtils::view(expected.get()));
+
+  SECTION("Stored buckets are served from disk")
+  {
+    std::unique_ptr<TimeSeries::ITimeSerie> second{
+        cache.getData(&provider, parameters)};
+    REQUIRE(second);
+    CHECK(provider.calls == 1);
+    check_same(TimeSeriesUtils::view(second.get()),
+               TimeSeriesUtils::view(expected.get()));
+  }
+  SECTION("Corrupt chunks are fetched again")
+  {
+    QDirIterator it{dir.path(), {QStringLiteral("*.chunk")}, QDir::Files,
+                    QDirIterator::Subdirectories};
+    REQUIRE(it.hasNext());
+    QFile chunk{it.next()};
+    REQUIRE(chunk.open(QIODevice::ReadWrite));
+    chunk.resize(8);
+    chunk.close();
+    std::unique_ptr<TimeSeries::ITimeSerie> second{
+        cache.getData(&provider, parameters)};
+    REQUIRE(second);
+    CHECK(provider.calls == 2);
+    check_same(TimeSeriesUtils::view(second.get()),
+               TimeSeriesUtils::view(expected.get()));
+  }
+  SECTION("A product changing shape bypasses the cache")
+  {
+    // the day before isn't stored yet, its chunk no longer fits the others
+    provider.vector = true;
+    const DataProviderParameters wider{
+        {parameters.m_Range.m_TStart - 86400., parameters.m_Range.m_TEnd},
+        {},
+        {}};
+    std::unique_ptr<TimeSeries::ITimeSerie> second{
+        cache.getData(&provider, wider)};
+    REQUIRE(second);
+    CHECK(provider.calls == 3);
+    CHECK(DataSeriesTypeUtils::type(second.get()) == DataSeriesType::VECTOR);
+  }
+}
+
+TEST_CASE("Sample cache only widens requests to stored buckets", "[mapped]")
+{
+  QTemporaryDir dir;
+  SampleCache cache{dir.path(), 1LL << 30, 86400.};
+  FakeProvider provider;
+  // 2020-01-01 10:00 to 2020-01-03 12:00, three buckets
+  const DataProviderParameters parameters{{1577872800., 1578052800.}, {}, {}};
+  const std::unique_ptr<TimeSeries::ITimeSerie> expected{
+      provider.getData(parameters)};
+  provider.calls = 0;
+  provider.requests.clear();
+  auto chunks = [&dir]() {
+    QDirIterator it{dir.path(), {QStringLiteral("*.chunk")}, QDir::Files,
+                    QDirIterator::Subdirectories};
+    int count = 0;
+    for(; it.hasNext(); it.next())
+      count++;
+    return count;
+  };
+  auto get = [&]() {
+    std::unique_ptr<TimeSeries::ITimeSerie> ts{
+        cache.getData(&provider, parameters)};
+    REQUIRE(ts);
+    check_same(TimeSeriesUtils::view(ts.get()),
+               TimeSeriesUtils::view(expected.get()));
+  };
+
+  SECTION("Unsettled buckets are fetched as requested")
+  {
+    provider.setCacheSettleDelay(1e10);
+    get();
+    get();
+    CHECK(provider.requests ==
+          std::vector<std::pair<double, double>>(2, {1577872800.,
+                                                     1578052800.}));
+    CHECK(chunks() == 0);
+  }
+  SECTION("Settled buckets are fetched whole and stored")
+  {
+    // settled up to 2020-01-03 00:00
+    provider.setCacheSettleDelay(
+        static_cast<double>(QDateTime::currentSecsSinceEpoch()) -
+        1578009600.);
+    get();
+    CHECK(provider.requests == std::vector<std::pair<double, double>>{
+                                   {1577836800., 1578009600.},
+                                   {1578009600., 1578052800.}});
+    CHECK(chunks() == 2);
+    get();
+    CHECK(provider.requests.back() ==
+          std::pair<double, double>{1578009600., 1578052800.});
+    CHECK(provider.calls == 3);
+  }
+  SECTION("Failed whole buckets fall back to the requested range")
+  {
+    provider.setCacheSettleDelay(0.);
+    provider.mission_start = 1577872800.;
+    get();
+    CHECK(provider.requests == std::vector<std::pair<double, double>>{
+                                   {1577836800., 1578096000.},
+                                   {1577872800., 1578052800.}});
+    CHECK(chunks() == 0);
+  }
+}
@@ -0,0 +1,263 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include <SciQLopCore/Data/TimePyramid.hpp>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using data_t = TimePyramid::data_t;
+
+namespace
+{
+  // samples every period seconds within [range.m_TStart, range.m_TEnd]
+  data_t make_samples(const DateTimeRange& range, double period,
+                      std::size_t components)
+  {
+    data_t data;
+    for(auto t = std::ceil(range.m_TStart / period) * period;
+        t <= range.m_TEnd; t += period)
+      data.first.push_back(t);
+    const auto size = std::size(data.first);
+    data.second.resize(size * components);
+    for(auto comp = 0UL; comp < components; comp++)
+      for(auto i = 0UL; i < size; i++)
+        data.second[comp * size + i] =
+            std::sin(data.first[i] * 1e-3 * static_cast<double>(comp + 1)) *
+                100. +
+            static_cast<double>(i % 7);
+    return data;
+  }
+
+  struct stats_t
+  {
+    double min        = std::numeric_limits<double>::infinity();
+    double max        = -std::numeric_limits<double>::infinity();
+    double sum        = 0.;
+    std::size_t count = 0;
+  };
+
+  // brute force aggregate of the samples within [start, start + width)
+  stats_t aggregate(const data_t& data, std::size_t component, double start,
+                    double width)
+  {
+    stats_t s;
+    const auto size = std::size(data.first);
+    for(auto i = 0UL; i < size; i++)
+    {
+      const auto t = data.first[i];
+      if(t < start || t >= start + width) continue;
+      const auto v = data.second[component * size + i];
+      s.min        = std::min(s.min, v);
+      s.max        = std::max(s.max, v);
+      s.sum += v;
+      s.count++;
+    }
+    return s;
+  }
+
+  void check_envelope(const data_t& samples, const data_t& view,
+                      std::size_t components)
+  {
+    const auto count = std::size(view.first);
+    REQUIRE(count >= 2);
+    REQUIRE(count % 2 == 0);
+    REQUIRE(std::size(view.second) == count * components);
+    // points are at 1/4 and 3/4 of each bin
+    const auto width = 2. * (view.first[1] - view.first[0]);
+    REQUIRE(width > 0.);
+    REQUIRE(std::log2(width) == Approx(std::round(std::log2(width))));
+    for(auto bin = 0UL; bin < count / 2; bin++)
+    {
+      const auto start = view.first[2 * bin] - width / 4.;
+      REQUIRE(view.first[2 * bin + 1] == Approx(start + 3. * width / 4.));
+      REQUIRE(std::fmod(start, width) == Approx(0.).margin(1e-9));
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        const auto expected = aggregate(samples, comp, start, width);
+        REQUIRE(expected.count != 0);
+        CHECK(view.second[comp * count + 2 * bin] == expected.min);
+        CHECK(view.second[comp * count + 2 * bin + 1] == expected.max);
+      }
+    }
+  }
+
+  void check_mean(const data_t& samples, const data_t& view,
+                  std::size_t components)
+  {
+    const auto count = std::size(view.first);
+    REQUIRE(count >= 2);
+    REQUIRE(std::size(view.second) == count * components);
+    // samples are contiguous so bins are too, points are at their centers
+    const auto width = view.first[1] - view.first[0];
+    REQUIRE(width > 0.);
+    for(auto bin = 0UL; bin < count; bin++)
+    {
+      const auto start = view.first[bin] - width / 2.;
+      for(auto comp = 0UL; comp < components; comp++)
+      {
+        const auto expected = aggregate(samples, comp, start, width);
+        REQUIRE(expected.count != 0);
+        CHECK(view.second[comp * count + bin] ==
+              Approx(expected.sum / static_cast<double>(expected.count)));
+      }
+    }
+  }
+} // namespace
+
+TEST_CASE("Time pyramid views match brute force aggregates", "[pyramid]")
+{
+  constexpr std::size_t components = 2;
+  // partial edge bins and tiles, with and without negative bin indexes
+  const auto range = GENERATE(DateTimeRange{-100000.3, 150000.7},
+                              DateTimeRange{-250000.5, -20000.25},
+                              DateTimeRange{1.6e9 + 0.5, 1.6e9 + 200000.5});
+  const auto samples = make_samples(range, 1., components);
+  TimePyramid pyramid{components};
+  pyramid.insert(samples, range);
+  REQUIRE(pyramid.size() != 0);
+
+  const auto delta = static_cast<double>(range.delta());
+  const auto window =
+      GENERATE_COPY(range, DateTimeRange{range.m_TStart + delta * 0.1,
+                                         range.m_TStart + delta * 0.7});
+  const auto pixels = GENERATE(as<std::size_t>{}, 100, 500, 1000);
+
+  SECTION("Envelope")
+  {
+    const auto view =
+        pyramid.get(window, pixels, TimePyramid::Aggregation::Envelope);
+    REQUIRE(view);
+    check_envelope(samples, *view, components);
+    // the view covers the window, at most an edge bin is missing each side
+    const auto width = 2. * (view->first[1] - view->first[0]);
+    CHECK(view->first.front() - width / 4. <= window.m_TStart + width);
+    CHECK(view->first.back() + width / 4. >= window.m_TEnd - width);
+  }
+  SECTION("Mean")
+  {
+    const auto view =
+        pyramid.get(window, pixels, TimePyramid::Aggregation::Mean);
+    REQUIRE(view);
+    check_mean(samples, *view, components);
+  }
+}
+
+TEST_CASE("Time pyramid only serves what it aggregated", "[pyramid]")
+{
+  const DateTimeRange range{-50000., 50000.};
+  const auto samples = make_samples(range, 1., 1);
+  TimePyramid pyramid{1};
+  SECTION("Empty pyramid") { CHECK_FALSE(pyramid.get(range, 100)); }
+  pyramid.insert(samples, range);
+  SECTION("Views finer than the aggregates need samples")
+  {
+    CHECK_FALSE(pyramid.get(range, std::size(samples.first)));
+  }
+  SECTION("Views outside the inserted range need samples")
+  {
+    CHECK_FALSE(pyramid.get({range.m_TEnd, range.m_TEnd + 100000.}, 100));
+    CHECK_FALSE(
+        pyramid.get({range.m_TStart - 50000., range.m_TStart + 50000.}, 100));
+  }
+  SECTION("Invalid requests")
+  {
+    CHECK_FALSE(pyramid.get(range, 0));
+    CHECK_FALSE(pyramid.get({range.m_TEnd, range.m_TStart}, 100));
+    CHECK_FALSE(pyramid.get(INVALID_RANGE, 100));
+  }
+  SECTION("Clear")
+  {
+    pyramid.clear();
+    CHECK(pyramid.size() == 0);
+    CHECK_FALSE(pyramid.get(range, 100));
+  }
+}
+
+TEST_CASE("Time pyramid gaps and NaN values", "[pyramid]")
+{
+  const DateTimeRange range{-30000., 30000.};
+  auto samples = make_samples(range, 1., 1);
+  // NaN samples are ignored by aggregates
+  for(auto i = 0UL; i < std::size(samples.second); i += 3)
+    samples.second[i] = std::nan("");
+  TimePyramid pyramid{1};
+  pyramid.insert(samples, range);
+  const auto view = pyramid.get(range, 200, TimePyramid::Aggregation::Envelope);
+  REQUIRE(view);
+  const auto count = std::size(view->first);
+  const auto width = 2. * (view->first[1] - view->first[0]);
+  for(auto bin = 0UL; bin < count / 2; bin++)
+  {
+    const auto start = view->first[2 * bin] - width / 4.;
+    stats_t expected;
+    const auto size = std::size(samples.first);
+    for(auto i = 0UL; i < size; i++)
+    {
+      const auto t = samples.first[i];
+      const auto v = samples.second[i];
+      if(t < start || t >= start + width || std::isnan(v)) continue;
+      expected.min = std::min(expected.min, v);
+      expected.max = std::max(expected.max, v);
+    }
+    CHECK(view->second[2 * bin] == expected.min);
+    CHECK(view->second[2 * bin + 1] == expected.max);
+  }
+}
+
+TEST_CASE("Time pyramid eviction", "[pyramid]")
+{
+  // a one tile budget
+  TimePyramid pyramid{1, 1};
+  const DateTimeRange first{-200000., -100000.};
+  const DateTimeRange second{100000., 200000.};
+  const auto first_samples  = make_samples(first, 1., 1);
+  const auto second_samples = make_samples(second, 1., 1);
+  pyramid.insert(first_samples, first);
+  CHECK(pyramid.size() == 1);
+  pyramid.insert(second_samples, second);
+  CHECK(pyramid.size() == 1);
+  // whatever survived must still be right
+  for(const auto& [range, samples] :
+      {std::pair{first, first_samples}, std::pair{second, second_samples}})
+  {
+    for(const auto pixels : {10UL, 100UL, 1000UL})
+      if(const auto view = pyramid.get(range, pixels))
+        check_envelope(samples, *view, 1);
+  }
+  // the least recently used tiles go first
+  TimePyramid large{1};
+  large.insert(first_samples, first);
+  const auto tiles = large.size();
+  // one tile holds bins_per_tile aggregates of 4 doubles per component
+  TimePyramid bounded{1, tiles * TimePyramid::bins_per_tile * 4 *
+                             sizeof(double)};
+  bounded.insert(first_samples, first);
+  REQUIRE(bounded.get(first, 100));
+  bounded.insert(second_samples, second);
+  CHECK(bounded.size() == tiles);
+  CHECK_FALSE(bounded.get(first, 100));
+  const auto view = bounded.get(second, 100);
+  REQUIRE(view);
+  check_envelope(second_samples, *view, 1);
+}
@@ -0,0 +1,179 @@
+/*------------------------------------------------------------------------------
+-- This file is a part of the SciQLop Software
+-- Copyright (C) 2022, Plasma Physics Laboratory - CNRS
+--
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation; either version 2 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+-------------------------------------------------------------------------------*/
+/*-- Author : Alexis Jeandet
+-- Mail : alexis.jeandet@member.fsf.org
+----------------------------------------------------------------------------*/
+#include <SciQLopCore/Data/TimeSerieMerge.hpp>
+#include <SciQLopCore/Data/TimeSeriesUtils.hpp>
+#include <catch2/catch.hpp>
+#include <memory>
+#include <vector>
+
+namespace
+{
+  // values[i] = 100 * t[i] + chunk, tells which chunk a sample came from
+  std::unique_ptr<ScalarTimeSerie> scalar(std::vector<double> t, double chunk)
+  {
+    std::vector<double> values(std::size(t));
+    for(auto i = 0UL; i < std::size(t); i++)
+      values[i] = 100. * t[i] + chunk;
+    return std::make_unique<ScalarTimeSerie>(std::move(t), std::move(values));
+  }
+
+  std::vector<double> times(const TimeSerieView& view)
+  {
+    return {view.t, view.t + view.size};
+  }
+
+  std::vector<double> values(const TimeSerieView& view)
+  {
+    return {view.values, view.values + view.size * view.columns};
+  }
+} // namespace
+
+TEST_CASE("Overlapping chunks are trimmed, first chunk wins", "[merge]")
+{
+  std::vector<std::unique_ptr<ScalarTimeSerie>> chunks;
+  SECTION("Duplicate timestamps")
+  {
+    chunks.push_back(scalar({1., 2., 3.}, 0.));
+    chunks.push_back(scalar({3., 3., 4., 5.}, 1.));
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(times(merged->view()) == std::vector<double>{1., 2., 3., 4., 5.});
+    CHECK(values(merged->view()) ==
+          std::vector<double>{100., 200., 300., 401., 501.});
+  }
+  SECTION("Fully contained chunk")
+  {
+    chunks.push_back(scalar({1., 2., 3., 4., 5., 6.}, 0.));
+    chunks.push_back(scalar({2., 3., 4.}, 1.));
+    chunks.push_back(scalar({6., 7.}, 2.));
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(times(merged->view()) ==
+          std::vector<double>{1., 2., 3., 4., 5., 6., 7.});
+    CHECK(values(merged->view()) ==
+          std::vector<double>{100., 200., 300., 400., 500., 600., 702.});
+  }
+  SECTION("Empty and null chunks")
+  {
+    chunks.push_back(scalar({}, 0.));
+    chunks.push_back(nullptr);
+    chunks.push_back(scalar({3., 4.}, 1.));
+    chunks.push_back(scalar({}, 2.));
+    chunks.push_back(scalar({1., 2.}, 3.));
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(times(merged->view()) == std::vector<double>{1., 2., 3., 4.});
+    CHECK(values(merged->view()) ==
+          std::vector<double>{103., 203., 301., 401.});
+  }
+  SECTION("Only empty chunks")
+  {
+    chunks.push_back(scalar({}, 0.));
+    chunks.push_back(nullptr);
+    CHECK_FALSE(TimeSeriesUtils::merge(std::move(chunks)));
+  }
+  SECTION("A single chunk left is moved, not copied")
+  {
+    chunks.push_back(scalar({1., 2., 3.}, 0.));
+    chunks.push_back(scalar({2., 3.}, 1.));
+    const auto data   = chunks.front()->view().t;
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(merged->view().t == data);
+  }
+}
+
+TEST_CASE("Views are trimmed in the order given", "[merge]")
+{
+  const std::vector<double> a{1., 2., 3.}, b{2., 3., 4.}, c{};
+  const std::vector<double> av{10., 20., 30.}, bv{21., 31., 41.};
+  std::vector<TimeSerieView> chunks{
+      {std::data(a), std::data(av), 3}, {}, {std::data(b), std::data(bv), 3}};
+  CHECK(TimeSeriesUtils::trim_overlaps(chunks) == 4);
+  CHECK(chunks[0].size == 3);
+  CHECK(chunks[1].empty());
+  REQUIRE(chunks[2].size == 1);
+  CHECK(chunks[2].t[0] == 4.);
+  CHECK(chunks[2].values[0] == 41.);
+}
+
+TEST_CASE("Every kind of serie merges through the same template", "[merge]")
+{
+  const std::vector<double> t1{1., 2., 3.}, t2{3., 4.};
+  SECTION("Vector")
+  {
+    std::vector<std::unique_ptr<VectorTimeSerie>> chunks;
+    chunks.push_back(std::make_unique<VectorTimeSerie>(
+        std::vector<double>{t1},
+        std::vector<Vector>{{1., 2., 3.}, {4., 5., 6.}, {7., 8., 9.}}));
+    chunks.push_back(std::make_unique<VectorTimeSerie>(
+        std::vector<double>{t2},
+        std::vector<Vector>{{0., 0., 0.}, {10., 11., 12.}}));
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(times(merged->view()) == std::vector<double>{1., 2., 3., 4.});
+    CHECK(values(merged->view()) ==
+          std::vector<double>{1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11.,
+                              12.});
+  }
+  SECTION("Spectrogram")
+  {
+    std::vector<std::unique_ptr<SpectrogramTimeSerie>> chunks;
+    chunks.push_back(std::make_unique<SpectrogramTimeSerie>(
+        std::vector<double>{t1}, std::vector<double>{10., 100.},
+        std::vector<double>{1., 2., 3., 4., 5., 6.},
+        std::initializer_list<std::size_t>{3, 2}, 1., 1.));
+    chunks.push_back(std::make_unique<SpectrogramTimeSerie>(
+        std::vector<double>{t2}, std::vector<double>{10., 100.},
+        std::vector<double>{0., 0., 7., 8.},
+        std::initializer_list<std::size_t>{2, 2}, 1., 1.));
+    const auto merged = TimeSeriesUtils::merge(std::move(chunks));
+    REQUIRE(merged);
+    CHECK(times(merged->view()) == std::vector<double>{1., 2., 3., 4.});
+    CHECK(values(merged->view()) ==
+          std::vector<double>{1., 2., 3., 4., 5., 6., 7., 8.});
+    CHECK(std::vector<double>(std::cbegin(merged->y_axis()),
+                              std::cend(merged->y_axis())) ==
+          std::vector<double>{10., 100.});
+  }
+  SECTION("Chunks of different shapes aren't merged")
+  {
+    std::vector<std::unique_ptr<MultiComponentTimeSerie>> chunks;
+    chunks.push_back(std::make_unique<MultiComponentTimeSerie>(
+        std::vector<double>{t1}, std::vector<double>(6),
+        std::initializer_list<std::size_t>{3, 2}));
+    chunks.push_back(std::make_unique<MultiComponentTimeSerie>(
+        std::vector<double>{t2}, std::vector<double>(6),
+        std::initializer_list<std::size_t>{2, 3}));
+    CHECK_FALSE(TimeSeriesUtils::merge(std::move(chunks)));
+  }
+  SECTION("Type erased")
+  {
+    const auto a = scalar({1., 2.}, 0.);
+    const auto b = scalar({2., 3.}, 1.);
+    std::unique_ptr<TimeSeries::ITimeSerie> merged{TimeSeriesUtils::merge(
+        {a->view(), b->view()}, TimeSerieLayout::of(*a))};
+    REQUIRE(DataSeriesTypeUtils::type(merged.get()) == DataSeriesType::SCALAR);
+    CHECK(values(TimeSeriesUtils::view(merged.get())) ==
+          std::vector<double>{100., 200., 301.});
+  }
+}